@@ -0,0 +1,108 @@
+#ifndef TEMPERATURE_CONTROL_SYSTEMS__LATENCY_HISTOGRAM_HPP_
+#define TEMPERATURE_CONTROL_SYSTEMS__LATENCY_HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// lock free latency histogram in microseconds, recording is a few relaxed atomic increments
+// buckets double in width and are split in 8 linear sub-buckets, bounding the error to 12.5%
+class LatencyHistogram {
+private:
+	// number of linear sub-buckets of every power of two
+	static constexpr int subBucketBits = 3;
+	static constexpr uint64_t subBucketCount = 1 << subBucketBits;
+	// latencies up to 2^40 us, longer ones land in the last bucket
+	static constexpr size_t bucketCount = subBucketCount * 38;
+	
+	// number of samples of every bucket
+	std::array<std::atomic<uint64_t>, bucketCount> buckets{};
+	// number of samples
+	std::atomic<uint64_t> count{0};
+	// sum of the samples
+	std::atomic<uint64_t> sum{0};
+	// largest sample
+	std::atomic<uint64_t> max{0};
+
+public:
+	// records one latency, safe to call from any thread
+	void
+	record(std::chrono::nanoseconds latency) {
+		auto micros = (uint64_t) std::max<int64_t>(
+				std::chrono::duration_cast<std::chrono::microseconds>(latency).count(), 0);
+		buckets[bucket_index(micros)].fetch_add(1, std::memory_order_relaxed);
+		count.fetch_add(1, std::memory_order_relaxed);
+		sum.fetch_add(micros, std::memory_order_relaxed);
+		auto previousMax = max.load(std::memory_order_relaxed);
+		while (micros > previousMax && !max.compare_exchange_weak(previousMax, micros, std::memory_order_relaxed)) {
+		}
+	}
+	
+	// number of recorded samples
+	uint64_t
+	samples() const {
+		return count.load(std::memory_order_relaxed);
+	}
+	
+	// mean of the samples in microseconds, zero without samples
+	double
+	mean_us() const {
+		auto samples = count.load(std::memory_order_relaxed);
+		return samples == 0 ? 0.0 : (double) sum.load(std::memory_order_relaxed) / (double) samples;
+	}
+	
+	// largest sample in microseconds
+	uint64_t
+	max_us() const {
+		return max.load(std::memory_order_relaxed);
+	}
+	
+	// upper bound in microseconds of the bucket holding the quantile, zero without samples
+	uint64_t
+	percentile_us(double quantile) const {
+		auto samples = count.load(std::memory_order_relaxed);
+		if (samples == 0) {
+			return 0;
+		}
+		auto rank = (uint64_t) (quantile * (double) samples);
+		uint64_t seen = 0;
+		for (size_t index = 0; index < bucketCount; index++) {
+			seen += buckets[index].load(std::memory_order_relaxed);
+			if (seen > rank) {
+				return std::min(bucket_upper_bound(index), max_us());
+			}
+		}
+		return max_us();
+	}
+
+private:
+	static size_t
+	bucket_index(uint64_t micros) {
+		if (micros < subBucketCount) {
+			return (size_t) micros;
+		}
+		// position of the highest bit, the next bits pick the sub-bucket
+		int exponent = subBucketBits;
+		for (auto remaining = micros >> (subBucketBits + 1); remaining != 0; remaining >>= 1) {
+			exponent++;
+		}
+		auto subBucket = (micros >> (exponent - subBucketBits)) - subBucketCount;
+		auto index = subBucketCount * (exponent - subBucketBits + 1) + subBucket;
+		return (size_t) std::min<uint64_t>(index, bucketCount - 1);
+	}
+	
+	static uint64_t
+	bucket_upper_bound(size_t index) {
+		if (index < subBucketCount) {
+			return index;
+		}
+		auto exponent = index / subBucketCount - 1 + subBucketBits;
+		auto subBucket = index % subBucketCount;
+		return ((subBucketCount + subBucket + 1) << (exponent - subBucketBits)) - 1;
+	}
+};
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS__LATENCY_HISTOGRAM_HPP_
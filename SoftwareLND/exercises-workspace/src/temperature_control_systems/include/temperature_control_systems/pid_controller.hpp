@@ -0,0 +1,36 @@
+#ifndef TEMPERATURE_CONTROL_SYSTEMS__PID_CONTROLLER_HPP_
+#define TEMPERATURE_CONTROL_SYSTEMS__PID_CONTROLLER_HPP_
+
+// discrete PID controller with bounded output
+// the derivative acts on the measurement so setpoint changes do not kick the output, and the integral stops
+// growing while the output is saturated in the direction of the error so it cannot wind up
+class PidController {
+private:
+	// gains of the proportional, integral and derivative terms
+	double proportionalGain;
+	double integralGain;
+	double derivativeGain;
+	// limits of the output
+	double outputMin;
+	double outputMax;
+	// integral term, already scaled by its gain
+	double integral = 0.0;
+	// measurement of the previous update
+	double lastMeasurement = 0.0;
+	// an update has happened since the last reset
+	bool started = false;
+
+public:
+	PidController(double proportionalGain, double integralGain, double derivativeGain,
+	              double outputMin, double outputMax);
+	
+	// output driving the measurement to the setpoint, the time step is the time since the previous update in seconds
+	double
+	update(double setpoint, double measurement, double timeStep, double feedForward = 0.0);
+	
+	// forgets the integral and the previous measurement
+	void
+	reset();
+};
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS__PID_CONTROLLER_HPP_
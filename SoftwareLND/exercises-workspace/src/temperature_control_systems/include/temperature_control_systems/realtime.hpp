@@ -0,0 +1,25 @@
+#ifndef TEMPERATURE_CONTROL_SYSTEMS__REALTIME_HPP_
+#define TEMPERATURE_CONTROL_SYSTEMS__REALTIME_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// locks every current and future page of the process in memory, so no page fault hits a callback
+// returns false with the reason in error when the process lacks the permission (CAP_IPC_LOCK or memlock limit)
+bool
+lock_process_memory(std::string &error);
+
+// touches the given size of the calling thread stack once, so its pages are resident before spinning
+void
+prefault_stack(size_t size);
+
+// names the calling thread, applies SCHED_FIFO at the priority and pins it to the cores
+// a priority of zero keeps the default scheduling policy, no cores keeps every core
+// returns false with the reason in error when a setting could not be applied
+bool
+configure_realtime_thread(const std::string &name, int priority, const std::vector<int64_t> &cpus,
+                          std::string &error);
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS__REALTIME_HPP_
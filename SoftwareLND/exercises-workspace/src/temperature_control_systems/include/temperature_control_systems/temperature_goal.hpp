@@ -0,0 +1,245 @@
+#ifndef TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_GOAL_HPP_
+#define TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_GOAL_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "rclcpp_action/rclcpp_action.hpp"
+
+#include "temperature_control_systems_interfaces/action/set_temperature.hpp"
+#include "temperature_control_systems_interfaces/action/set_temperature_compact.hpp"
+#include "temperature_control_systems_interfaces/action/set_temperature_schedule.hpp"
+
+// how a goal ended, the values match the STATUS constants of the compact result
+enum class GoalStatus : uint8_t {
+	SUCCEEDED,
+	CANCELLED,
+	PREEMPTED,
+	SERVICE_UNAVAILABLE,
+	SERVICE_TIMED_OUT,
+	SHUTTING_DOWN,
+	DEACTIVATED
+};
+
+// terminal state of a goal handle
+enum class GoalOutcome {
+	SUCCEEDED,
+	CANCELED,
+	ABORTED
+};
+
+// every status but success and cancellation aborts the goal
+inline GoalOutcome
+goal_outcome(GoalStatus status) {
+	switch (status) {
+		case GoalStatus::SUCCEEDED:
+			return GoalOutcome::SUCCEEDED;
+		case GoalStatus::CANCELLED:
+			return GoalOutcome::CANCELED;
+		default:
+			return GoalOutcome::ABORTED;
+	}
+}
+
+// goal run by the stepping engine of a zone, whatever the action carrying it
+class TemperatureGoal {
+public:
+	virtual ~TemperatureGoal() = default;
+	
+	// thermal zone to control
+	virtual uint8_t
+	zone() const = 0;
+	
+	// temperature to reach
+	virtual short
+	target_temperature() const = 0;
+	
+	// largest number of degrees moved by one actuation step
+	virtual short
+	step_size() const = 0;
+	
+	// true once the client asked to cancel the goal
+	virtual bool
+	is_canceling() const = 0;
+	
+	// seconds to hold the target once reached before moving on
+	virtual double
+	hold_time() const {
+		return 0.0;
+	}
+	
+	// moves on to the next target once the current one was held, returns false when none is left
+	virtual bool
+	next_target() {
+		return false;
+	}
+	
+	// publishes the progress towards the target
+	virtual void
+	publish_feedback(short temperature, short progress, float timeRemaining) = 0;
+	
+	// ends the goal, the message is only sent by the verbose interfaces
+	virtual void
+	finish(GoalStatus status, short temperature, const char *message) = 0;
+};
+
+// verbose results carry the message, compact ones the status code
+inline void
+set_goal_result_status(temperature_control_systems_interfaces::action::SetTemperature::Result &result,
+                       GoalStatus, const char *message) {
+	result.message = message;
+}
+
+inline void
+set_goal_result_status(temperature_control_systems_interfaces::action::SetTemperatureCompact::Result &result,
+                       GoalStatus status, const char *) {
+	result.status = (uint8_t) status;
+}
+
+// goal of an action sharing the goal and feedback fields of SetTemperature
+template<class Action>
+class ActionTemperatureGoal : public TemperatureGoal {
+private:
+	// handle of the goal on the action server
+	std::shared_ptr<rclcpp_action::ServerGoalHandle<Action>> goalHandle;
+	// feedback reused across the steps of the goal
+	std::shared_ptr<typename Action::Feedback> feedback = std::make_shared<typename Action::Feedback>();
+
+public:
+	explicit ActionTemperatureGoal(std::shared_ptr<rclcpp_action::ServerGoalHandle<Action>> goalHandle)
+		: goalHandle(std::move(goalHandle)) {
+	}
+	
+	uint8_t
+	zone() const override {
+		return goalHandle->get_goal()->zone;
+	}
+	
+	short
+	target_temperature() const override {
+		return goalHandle->get_goal()->temperature;
+	}
+	
+	short
+	step_size() const override {
+		return goalHandle->get_goal()->step_size;
+	}
+	
+	bool
+	is_canceling() const override {
+		return goalHandle->is_canceling();
+	}
+	
+	void
+	publish_feedback(short temperature, short progress, float timeRemaining) override {
+		feedback->temperature = temperature;
+		feedback->progress = progress;
+		feedback->time_remaining = timeRemaining;
+		goalHandle->publish_feedback(feedback);
+	}
+	
+	void
+	finish(GoalStatus status, short temperature, const char *message) override {
+		auto result = std::make_shared<typename Action::Result>();
+		result->success = status == GoalStatus::SUCCEEDED;
+		result->temperature = temperature;
+		set_goal_result_status(*result, status, message);
+		switch (goal_outcome(status)) {
+			case GoalOutcome::SUCCEEDED:
+				goalHandle->succeed(result);
+				break;
+			case GoalOutcome::CANCELED:
+				goalHandle->canceled(result);
+				break;
+			case GoalOutcome::ABORTED:
+				goalHandle->abort(result);
+				break;
+		}
+	}
+};
+
+// goal of the schedule action, reaching and holding its segments one after the other
+class ScheduleTemperatureGoal : public TemperatureGoal {
+public:
+	using SetTemperatureSchedule = temperature_control_systems_interfaces::action::SetTemperatureSchedule;
+
+private:
+	// handle of the goal on the action server
+	std::shared_ptr<rclcpp_action::ServerGoalHandle<SetTemperatureSchedule>> goalHandle;
+	// feedback reused across the steps of every segment
+	std::shared_ptr<SetTemperatureSchedule::Feedback> feedback = std::make_shared<SetTemperatureSchedule::Feedback>();
+	// index of the segment being executed
+	size_t segment = 0;
+
+public:
+	explicit ScheduleTemperatureGoal(std::shared_ptr<rclcpp_action::ServerGoalHandle<SetTemperatureSchedule>> goalHandle)
+		: goalHandle(std::move(goalHandle)) {
+	}
+	
+	uint8_t
+	zone() const override {
+		return goalHandle->get_goal()->zone;
+	}
+	
+	short
+	target_temperature() const override {
+		return goalHandle->get_goal()->segments[segment].temperature;
+	}
+	
+	short
+	step_size() const override {
+		return goalHandle->get_goal()->step_size;
+	}
+	
+	bool
+	is_canceling() const override {
+		return goalHandle->is_canceling();
+	}
+	
+	double
+	hold_time() const override {
+		return goalHandle->get_goal()->segments[segment].hold_time;
+	}
+	
+	bool
+	next_target() override {
+		if (segment + 1 >= goalHandle->get_goal()->segments.size()) {
+			return false;
+		}
+		segment++;
+		return true;
+	}
+	
+	void
+	publish_feedback(short temperature, short progress, float timeRemaining) override {
+		feedback->temperature = temperature;
+		feedback->progress = progress;
+		feedback->time_remaining = timeRemaining;
+		feedback->segment = (uint16_t) segment;
+		goalHandle->publish_feedback(feedback);
+	}
+	
+	void
+	finish(GoalStatus status, short temperature, const char *message) override {
+		auto result = std::make_shared<SetTemperatureSchedule::Result>();
+		result->success = status == GoalStatus::SUCCEEDED;
+		result->temperature = temperature;
+		result->message = message;
+		// the last segment only counts once it was held
+		result->segments_completed = (uint16_t) (result->success ? segment + 1 : segment);
+		switch (goal_outcome(status)) {
+			case GoalOutcome::SUCCEEDED:
+				goalHandle->succeed(result);
+				break;
+			case GoalOutcome::CANCELED:
+				goalHandle->canceled(result);
+				break;
+			case GoalOutcome::ABORTED:
+				goalHandle->abort(result);
+				break;
+		}
+	}
+};
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_GOAL_HPP_
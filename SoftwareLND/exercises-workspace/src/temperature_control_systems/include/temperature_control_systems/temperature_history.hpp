@@ -0,0 +1,60 @@
+#ifndef TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_HISTORY_HPP_
+#define TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_HISTORY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// fixed capacity ring buffer of timestamped temperatures of every zone, allocated once
+// samples must be appended in time order, the oldest one is overwritten once full
+class TemperatureHistory {
+public:
+	// aggregates of the samples of a zone within a window
+	struct Statistics {
+		size_t count = 0;
+		short min = 0;
+		short max = 0;
+		double mean = 0.0;
+	};
+
+private:
+	// largest number of samples kept
+	size_t capacity;
+	// number of temperatures of every sample
+	size_t zoneCount;
+	// time of every sample in nanoseconds
+	std::vector<int64_t> stamps;
+	// temperatures of every zone, one row per sample
+	std::vector<short> temperatures;
+	// slot of the next sample
+	size_t next = 0;
+	// number of samples kept
+	size_t size = 0;
+
+public:
+	TemperatureHistory(size_t capacity, size_t zoneCount);
+	
+	// row to fill with the temperatures of every zone at the stamp
+	short *
+	append(int64_t stamp);
+	
+	// aggregates of the samples of the zone taken at or after the stamp
+	Statistics
+	statistics(size_t zone, int64_t since) const;
+	
+	// averages the samples of the zone taken at or after the stamp down to at most the number of samples
+	void
+	compact(size_t zone, int64_t since, size_t maxSamples,
+	        std::vector<int64_t> &compactedStamps, std::vector<float> &compactedTemperatures) const;
+
+private:
+	// position from the oldest sample of the first sample taken at or after the stamp
+	size_t
+	first_since(int64_t since) const;
+	
+	// slot of the sample at the position from the oldest one
+	size_t
+	slot(size_t position) const;
+};
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_HISTORY_HPP_
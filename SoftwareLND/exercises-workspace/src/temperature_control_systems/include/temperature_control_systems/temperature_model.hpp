@@ -0,0 +1,54 @@
+#ifndef TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_MODEL_HPP_
+#define TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_MODEL_HPP_
+
+// thermal behaviour of a zone, integrated by the node at a fixed rate
+// the power of the actuator goes from -1, full cooling, to 1, full heating
+class TemperatureModel {
+public:
+	virtual ~TemperatureModel() = default;
+	
+	// temperature after the time step in seconds with the actuator held at the power
+	virtual double
+	step(double temperature, double power, double timeStep) const = 0;
+	
+	// rate of change of the temperature in degrees per second with the actuator at the power
+	virtual double
+	rate(double temperature, double power) const = 0;
+	
+	// seconds needed to reach the target at full power, infinity when the actuator cannot reach it
+	virtual double
+	time_to_target(double temperature, double target) const = 0;
+};
+
+// the zone relaxes towards the ambient temperature while the actuator adds a bounded heat flow
+// dT/dt = (ambient - T) / timeConstant + heatingRate * maxPower * power
+class FirstOrderTemperatureModel : public TemperatureModel {
+private:
+	// temperature the zone settles at with the actuator off
+	double ambientTemperature;
+	// seconds for the zone to close 63% of its gap to the ambient temperature
+	double timeConstant;
+	// degrees per second added by the actuator at full power
+	double heatingRate;
+	// fraction of the actuator power available, limiting heating and cooling alike
+	double maxPower;
+
+public:
+	FirstOrderTemperatureModel(double ambientTemperature, double timeConstant, double heatingRate, double maxPower);
+	
+	double
+	step(double temperature, double power, double timeStep) const override;
+	
+	double
+	rate(double temperature, double power) const override;
+	
+	double
+	time_to_target(double temperature, double target) const override;
+
+private:
+	// temperature the zone settles at with the actuator held at the power
+	double
+	equilibrium(double power) const;
+};
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_MODEL_HPP_
@@ -0,0 +1,574 @@
+#ifndef TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_SYSTEMS_CONTROLLER_HPP_
+#define TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_SYSTEMS_CONTROLLER_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_action/rclcpp_action.hpp"
+#include "std_msgs/msg/int16.hpp"
+#ifdef TEMPERATURE_CONTROL_SYSTEMS_USE_TLSF
+#include "tlsf_cpp/tlsf.hpp"
+#endif
+
+#include "temperature_control_systems/latency_histogram.hpp"
+#include "temperature_control_systems/pid_controller.hpp"
+#include "temperature_control_systems/temperature_goal.hpp"
+#include "temperature_control_systems/temperature_history.hpp"
+#include "temperature_control_systems/temperature_model.hpp"
+
+#include "temperature_control_systems_interfaces/msg/zone_temperatures.hpp"
+
+#include "temperature_control_systems_interfaces/srv/get_current_temperature.hpp"
+#include "temperature_control_systems_interfaces/srv/get_temperature_history.hpp"
+#include "temperature_control_systems_interfaces/srv/get_zone_temperatures.hpp"
+#include "temperature_control_systems_interfaces/srv/increment_decrement_temperature.hpp"
+#include "temperature_control_systems_interfaces/srv/increment_decrement_temperature_compact.hpp"
+#include "temperature_control_systems_interfaces/action/set_temperature.hpp"
+#include "temperature_control_systems_interfaces/action/set_temperature_compact.hpp"
+
+class TemperatureSystemsControllerNode : public rclcpp::Node {
+public:
+	using ZoneTemperatures = temperature_control_systems_interfaces::msg::ZoneTemperatures;
+	using GetCurrentTemperature = temperature_control_systems_interfaces::srv::GetCurrentTemperature;
+	using GetZoneTemperatures = temperature_control_systems_interfaces::srv::GetZoneTemperatures;
+	using GetTemperatureHistory = temperature_control_systems_interfaces::srv::GetTemperatureHistory;
+	using IncrementDecrementTemperature = temperature_control_systems_interfaces::srv::IncrementDecrementTemperature;
+	using IncrementDecrementTemperatureCompact =
+			temperature_control_systems_interfaces::srv::IncrementDecrementTemperatureCompact;
+	using SetTemperature = temperature_control_systems_interfaces::action::SetTemperature;
+	using SetTemperatureCompact = temperature_control_systems_interfaces::action::SetTemperatureCompact;
+	using SetTemperatureSchedule = temperature_control_systems_interfaces::action::SetTemperatureSchedule;
+#ifdef TEMPERATURE_CONTROL_SYSTEMS_USE_TLSF
+	// telemetry copies come from a TLSF pool, bounded time and no system allocation once warmed up
+	using TelemetryAllocator = tlsf_heap_allocator<void>;
+#else
+	using TelemetryAllocator = std::allocator<void>;
+#endif
+
+private:
+	// context prefix of every topic, service and action name
+	std::string contextPrefix = "temperature_control_systems";
+	// number of thermal zones served by the node
+	size_t zoneCount = 1;
+	// current temperature of every zone, read by the telemetry and services without locking
+	std::vector<std::atomic<short>> zoneTemperatures;
+	// temperature targeted by the active goal of every zone
+	std::vector<std::atomic<short>> zoneTargetTemperatures;
+	// time of the last change of every zone in nanoseconds of the node clock
+	std::vector<std::atomic<int64_t>> zoneUpdateStamps;
+	// whether a goal is running on every zone
+	std::vector<std::atomic<bool>> zoneBusy;
+	static_assert(std::atomic<short>::is_always_lock_free, "temperature must be lock free");
+	// timer to monitor the temperature
+	rclcpp::TimerBase::SharedPtr temperatureMonitorTimer;
+	// publisher to publish the temperature of the first zone
+	rclcpp::Publisher<std_msgs::msg::Int16, TelemetryAllocator>::SharedPtr temperaturePublisher;
+	// the telemetry is delivered intra process, messages are then handed over instead of reused
+	bool telemetryIntraProcess = false;
+	// message reused by every inter process publication when the middleware cannot loan one
+	std_msgs::msg::Int16 temperatureMessage;
+	// publisher to publish the temperatures of every zone in one message, only with several zones
+	rclcpp::Publisher<ZoneTemperatures, TelemetryAllocator>::SharedPtr zoneTemperaturesPublisher;
+	// message reused by every inter process zones publication when the middleware cannot loan one
+	ZoneTemperatures zoneTemperaturesMessage;
+	// only publish when the temperature moved past the deadband or the publisher was silent for too long
+	bool telemetryPublishOnChange = false;
+	// change of temperature ignored by the publish on change mode
+	int telemetryDeadband = 0;
+	// longest time without a publication in publish on change mode
+	std::chrono::nanoseconds telemetryMaxSilence{std::chrono::seconds(10)};
+	// temperature of the last publication
+	short lastPublishedTemperature = 0;
+	// time of the last publication, nothing has been published when empty
+	std::chrono::steady_clock::time_point lastTemperaturePublishTime;
+	// temperatures of the last zones publication
+	std::vector<short> lastPublishedZoneTemperatures;
+	// time of the last zones publication, nothing has been published when empty
+	std::chrono::steady_clock::time_point lastZoneTemperaturesPublishTime;
+	// service that returns the current temperature
+	rclcpp::Service<GetCurrentTemperature>::SharedPtr getCurrentTemperatureService;
+	// service that returns the current temperatures of several zones in one call
+	rclcpp::Service<GetZoneTemperatures>::SharedPtr getZoneTemperaturesService;
+	// temperatures of every zone sampled by the monitor, empty when the history is disabled
+	std::unique_ptr<TemperatureHistory> temperatureHistory;
+	// service that returns windowed statistics and compacted samples of the history
+	rclcpp::Service<GetTemperatureHistory>::SharedPtr getTemperatureHistoryService;
+	// stamps of the compacted samples, reserved once for the largest request
+	std::vector<int64_t> historyStamps;
+	// service that increments or decrements the current temperature
+	rclcpp::Service<IncrementDecrementTemperature>::SharedPtr incrementDecrementTemperatureService;
+	// action server to set the temperature
+	rclcpp_action::Server<SetTemperature>::SharedPtr setTemperatureActionServer;
+	// serve the interfaces carrying human readable messages next to the compact ones
+	bool verboseInterfaces = true;
+	// increment/decrement service answering with a status code, a plain fixed size response
+	rclcpp::Service<IncrementDecrementTemperatureCompact>::SharedPtr incrementDecrementTemperatureCompactService;
+	// set temperature action ending with a status code, a plain fixed size result
+	rclcpp_action::Server<SetTemperatureCompact>::SharedPtr setTemperatureCompactActionServer;
+	// action server running a schedule of targets and holds as one goal
+	rclcpp_action::Server<SetTemperatureSchedule>::SharedPtr setTemperatureScheduleActionServer;
+	// run the action through the increment/decrement service instead of the stepper
+	bool actionLoopback = false;
+	// client shared by every loopback goal to call the increment/decrement service
+	rclcpp::Client<IncrementDecrementTemperature>::SharedPtr incrementDecrementTemperatureClient;
+	// bound on waiting for the increment/decrement service and for each of its responses
+	std::chrono::milliseconds loopbackServiceTimeout{5000};
+	// largest number of degrees the actuator moves in one command
+	short maxActuationStep = 10;
+	
+	// what happens to a goal arriving while another one is running
+	enum class GoalPolicy {
+		REJECT,
+		QUEUE,
+		PREEMPT
+	} goalPolicy = GoalPolicy::REJECT;
+	// shortest time between two feedbacks of a goal, zero publishes every step
+	std::chrono::nanoseconds feedbackMinInterval{0};
+	// smallest change of progress in percent worth a feedback, zero publishes every step
+	int feedbackMinProgressStep = 0;
+	// guards the goals of every zone and the pausing of the timers, shared by the actuation callback group, the
+	// loopback responses and the activation
+	std::mutex goalMutex;
+	// timers run and goals and commands are admitted, cleared by a deactivation of the lifecycle variant
+	std::atomic<bool> active{true};
+	
+	// goals of a zone, executed by its stepper, its loopback or the temperature model
+	struct ZoneGoals {
+		// goal being executed, from any of the set temperature actions
+		std::shared_ptr<TemperatureGoal> goal;
+		// goals waiting for the active one to finish
+		std::deque<std::shared_ptr<TemperatureGoal>> queuedGoals;
+		// timer driving the stepper of the zone, created once and re-armed by every step
+		rclcpp::TimerBase::SharedPtr stepperTimer;
+		// node clock time the stepper timer is due, a dispatch before it was armed earlier and is ignored
+		int64_t stepperDeadline = std::numeric_limits<int64_t>::max();
+		// timer of the loopback, created once and re-armed to poll the service or bound the wait for a response
+		rclcpp::TimerBase::SharedPtr loopbackTimer;
+		// node clock time the loopback timer is due, the largest value while it is not armed
+		int64_t loopbackDeadline = std::numeric_limits<int64_t>::max();
+		// loopback sequence the timer was armed for, and whether it bounds the wait for a response
+		uint64_t loopbackTimerSequence = 0;
+		bool loopbackTimerTimedOut = false;
+		// request reused by every step of the loopback
+		std::shared_ptr<IncrementDecrementTemperature::Request> loopbackRequest;
+		// id of the loopback request in flight, to drop it on timeout
+		int64_t loopbackRequestId = -1;
+		// bumped by every loopback request and timeout, so stale responses and timers are ignored
+		uint64_t loopbackSequence = 0;
+		// time the loopback started waiting for the service, empty while the service is ready
+		std::chrono::steady_clock::time_point loopbackServiceWaitStart;
+		// temperature when the goal was accepted
+		short initialTemperature = 0;
+		// a step has been started and is waiting for its actuation delay
+		bool actuating = false;
+		// largest number of degrees moved by one step
+		short stepSize = 1;
+		// signed number of degrees moved by the step being actuated
+		short actuationDelta = 0;
+		// progress of the last published feedback, negative before the first one
+		int lastFeedbackProgress = -1;
+		// the target of the goal was reached and is being held
+		bool holding = false;
+		// node clock time the hold of the target ends, in nanoseconds
+		int64_t holdEnd = 0;
+		// time of the last published feedback
+		std::chrono::steady_clock::time_point lastFeedbackTime;
+		// time the step being actuated was commanded
+		std::chrono::steady_clock::time_point stepStartTime;
+	};
+	// goals of every zone
+	std::vector<ZoneGoals> zoneGoals;
+	
+	// respond to increment/decrement requests when their actuation delay elapses instead of sleeping
+	bool deferredActuationResponse = true;
+	// skip the per request logs and success messages of the service hot paths
+	bool quietMode = false;
+	// increment/decrement request waiting for its actuation delay, its slot and response are reused
+	template<class Service>
+	struct DeferredActuation {
+		// the slot holds a request to respond to
+		bool pending = false;
+		// client and sequence number of the request
+		rmw_request_id_t requestHeader{};
+		// node clock time the actuation delay elapses, in nanoseconds
+		int64_t deadline = 0;
+		// command of the request
+		uint8_t zone = 0;
+		bool isIncrement = false;
+		short delta = 0;
+		// time the request was received
+		std::chrono::steady_clock::time_point start;
+		// response allocated with the slot
+		std::shared_ptr<typename Service::Response> response;
+	};
+	// deferred requests of one service, completed by a single timer armed for the earliest deadline
+	template<class Service>
+	struct DeferredActuations {
+		// service sending the responses
+		std::shared_ptr<rclcpp::Service<Service>> service;
+		// slots allocated at construction, a request finding none free is refused
+		std::vector<DeferredActuation<Service>> slots;
+		// response of the requests answered at once when every slot is pending
+		std::shared_ptr<typename Service::Response> overflowResponse;
+		// timer completing the due requests
+		rclcpp::TimerBase::SharedPtr timer;
+		// node clock time the timer is due, the largest value while it is not armed
+		int64_t timerDeadline = std::numeric_limits<int64_t>::max();
+	};
+	// deferred requests of the verbose and compact services
+	std::tuple<DeferredActuations<IncrementDecrementTemperature>,
+	           DeferredActuations<IncrementDecrementTemperatureCompact>> deferredActuations;
+	
+	// timer publishing the diagnostics
+	rclcpp::TimerBase::SharedPtr diagnosticsTimer;
+	// publisher of the counters and latencies on the diagnostics topic
+	rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr diagnosticsPublisher;
+	// time taken to handle the get temperature requests
+	LatencyHistogram readLatency;
+	// time between an increment/decrement request and its response
+	LatencyHistogram actuationLatency;
+	// time between commanding a step of a goal and the temperature moving
+	LatencyHistogram stepLatency;
+	// number of increment/decrement commands applied and refused
+	std::atomic<uint64_t> actuationsCompleted{0};
+	std::atomic<uint64_t> actuationsRefused{0};
+	// number of goals admitted and rejected
+	std::atomic<uint64_t> goalsAccepted{0};
+	std::atomic<uint64_t> goalsRejected{0};
+	// number of goals ended with every outcome
+	std::array<std::atomic<uint64_t>, 3> goalOutcomes{};
+	// number of power changes sent to the actuators by the temperature model
+	std::atomic<uint64_t> actuatorCommands{0};
+	// number of temperature and feedback messages published
+	std::atomic<uint64_t> temperaturePublishCount{0};
+	std::atomic<uint64_t> feedbackPublishCount{0};
+	
+	// callback group of the entities that only read the temperature
+	rclcpp::CallbackGroup::SharedPtr readCallbackGroup;
+	// callback group of the temperature monitor
+	rclcpp::CallbackGroup::SharedPtr telemetryCallbackGroup;
+	// callback group of the entities that change the temperature, serialized with each other
+	rclcpp::CallbackGroup::SharedPtr actuationCallbackGroup;
+	
+	// uniform random number generator, the same seed gives the same sequence with every standard library
+	std::mt19937 randomNumber;
+	// scale of the simulated actuation delays
+	std::atomic<double> actuationDelayScale{1.0};
+	// range of the simulated actuation delays in milliseconds, the maximum is excluded
+	std::atomic<int64_t> actuationDelayMin{100};
+	std::atomic<int64_t> actuationDelayMax{500};
+	// share of the commands refused by the actuator, compared against the raw 32 bit draws
+	std::atomic<double> actuationRefusalRate{0.5};
+	// applies the parameters tunable on a running node, rejecting the ones only read at startup
+	rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr setParametersCallbackHandle;
+	
+	// thermal model integrated at a fixed step, none moves the temperature by discrete steps
+	std::unique_ptr<TemperatureModel> temperatureModel;
+	// timer integrating the model
+	rclcpp::TimerBase::SharedPtr temperatureModelTimer;
+	// seconds between two model updates
+	double temperatureModelTimeStep = 0.01;
+	// rate in degrees per second at which the zones approach their setpoint, per degree of error
+	double modelControlGain = 1.0;
+	// exact temperature of every zone, only touched by the actuation callback group
+	std::vector<double> zoneModelTemperatures;
+	// temperature the actuator of every zone drives to, not a number while the actuator is off
+	std::vector<double> zoneSetpoints;
+	// power commanded to the actuator of every zone, held until the next command
+	std::vector<double> zonePowers;
+	// smallest change of power worth an actuator command
+	double controlOutputDeadband = 0.01;
+	// drive the actuators with a PID controller on the control timer instead of the proportional law
+	bool pidControl = false;
+	// PID controller of every zone
+	std::vector<PidController> zonePidControllers;
+	// timer running the PID controllers
+	rclcpp::TimerBase::SharedPtr controlTimer;
+	// seconds between two PID updates
+	double controlTimeStep = 0.1;
+
+public:
+	explicit TemperatureSystemsControllerNode(const rclcpp::NodeOptions &options = rclcpp::NodeOptions());
+	
+	// node with its own name, hosted by the lifecycle variant
+	TemperatureSystemsControllerNode(const std::string &nodeName, const std::string &nodeNamespace,
+	                                 const rclcpp::NodeOptions &options);
+	
+	~TemperatureSystemsControllerNode() override;
+	
+	// pauses the timers and ends the goals, refusing new goals and commands, or resumes them
+	// no entity is created or destroyed, reads keep being served
+	void
+	set_active(bool activate);
+	
+	// whether the timers run and goals and commands are admitted
+	bool
+	is_active() const;
+	
+	// callback group of the services reading the temperatures and of the loopback client
+	rclcpp::CallbackGroup::SharedPtr
+	read_callback_group() const;
+	
+	// callback group of the monitor, the history and the diagnostics
+	rclcpp::CallbackGroup::SharedPtr
+	telemetry_callback_group() const;
+	
+	// callback group of the actuation service, the action, its timers and the model
+	rclcpp::CallbackGroup::SharedPtr
+	actuation_callback_group() const;
+	
+	// applies the real time settings of the callback groups to the calling thread, which spins all of them
+	// it takes the highest priority and every core configured for the groups, threads it starts inherit them
+	void
+	configure_shared_executor_thread(const std::string &name) const;
+
+private:
+	// validates and applies a set of parameters changed on the running node
+	rcl_interfaces::msg::SetParametersResult
+	set_parameters_callback(const std::vector<rclcpp::Parameter> &parameters);
+	
+	// creates the monitor timer publishing at the rate, replacing the previous one, called with the goal mutex held
+	void
+	create_temperature_monitor_timer(double rate);
+	
+	// publishes the current temperatures
+	void
+	temperature_monitor_callback();
+	
+	// whether a publication is due in publish on change mode, updating its time when it is
+	bool
+	telemetry_due(bool changed,
+	              std::chrono::steady_clock::time_point &lastPublishTime,
+	              std::chrono::steady_clock::time_point now);
+	
+	// publishes the temperatures of every zone
+	void
+	publish_zone_temperatures(std::chrono::steady_clock::time_point now);
+	
+	// quality of service of the temperature publisher from the telemetry parameters
+	rclcpp::QoS
+	telemetry_qos();
+	
+	// returns the current temperature
+	void
+	get_current_temperature_callback(
+			const std::shared_ptr<GetCurrentTemperature::Request> &request,
+			const std::shared_ptr<GetCurrentTemperature::Response> &response);
+	
+	// returns the current temperatures of the requested zones, or of every zone
+	void
+	get_zone_temperatures_callback(
+			const std::shared_ptr<GetZoneTemperatures::Request> &request,
+			const std::shared_ptr<GetZoneTemperatures::Response> &response);
+	
+	// returns the statistics and compacted samples of a zone over a window of the history
+	void
+	get_temperature_history_callback(
+			const std::shared_ptr<GetTemperatureHistory::Request> &request,
+			const std::shared_ptr<GetTemperatureHistory::Response> &response);
+	
+	// moves the temperature of the zone and records the time of the change, returns the new temperature
+	short
+	change_zone_temperature(uint8_t zone, short delta);
+	
+	// increments or decrements the temperature, sleeping for the actuation delay
+	// the service is the verbose or the compact increment/decrement service
+	template<class Service>
+	void
+	increment_decrement_temperature_callback(
+			const std::shared_ptr<typename Service::Request> &request,
+			const std::shared_ptr<typename Service::Response> &response);
+	
+	// increments or decrements the temperature, responding once the actuation delay elapses
+	template<class Service>
+	void
+	increment_decrement_temperature_deferred_callback(
+			const std::shared_ptr<rclcpp::Service<Service>> &service,
+			const std::shared_ptr<rmw_request_id_t> &requestHeader,
+			const std::shared_ptr<typename Service::Request> &request);
+	
+	// allocates the slots of the deferred requests of the service and its timer completing them
+	template<class Service>
+	void
+	create_deferred_actuations(const std::shared_ptr<rclcpp::Service<Service>> &service, size_t slotCount);
+	
+	// responds to the deferred requests of the service whose actuation delay elapsed
+	template<class Service>
+	void
+	complete_deferred_actuations();
+	
+	// fills the response of a command refused by the actuator, or invalid for the zone or delta
+	template<class Response>
+	void
+	reject_increment_decrement_temperature(
+			uint8_t zone,
+			bool isIncrement,
+			short delta,
+			const std::shared_ptr<Response> &response);
+	
+	// applies an accepted command and fills its response
+	template<class Response>
+	void
+	complete_increment_decrement_temperature(
+			uint8_t zone,
+			bool isIncrement,
+			short delta,
+			const std::shared_ptr<Response> &response);
+	
+	// moves the setpoint of the zone modelled by the temperature model and fills the response
+	template<class Response>
+	void
+	command_temperature_model(
+			uint8_t zone,
+			bool isIncrement,
+			short delta,
+			const std::shared_ptr<Response> &response);
+	
+	// number of degrees a command actually moves, within the actuator limit
+	short
+	actuation_step(int delta) const;
+	
+	// whether the actuator accepts the next command
+	bool
+	can_actuate_temperature();
+	
+	// simulated time taken by the actuator to apply a command
+	std::chrono::milliseconds
+	actuation_delay();
+	
+	// wait before commanding again after a refusal, the scaled minimum actuation delay and at least a millisecond
+	std::chrono::milliseconds
+	actuation_retry_delay() const;
+	
+	// the action is the verbose or the compact set temperature action
+	template<class Action>
+	rclcpp_action::GoalResponse
+	handle_set_temperature_action_callback(const rclcpp_action::GoalUUID &uuid,
+	                                       const std::shared_ptr<const typename Action::Goal> &goal);
+	
+	template<class Action>
+	rclcpp_action::CancelResponse
+	cancel_set_temperature_action_callback(
+			const std::shared_ptr<rclcpp_action::ServerGoalHandle<Action>> &goalHandle);
+	
+	// hands an accepted goal of any set temperature action to the engine of its zone
+	void
+	accepted_set_temperature_action_callback(const std::shared_ptr<TemperatureGoal> &goal);
+	
+	// sends the next increment/decrement request of the active goal of the zone, called with the goal mutex held
+	void
+	loopback_set_temperature_step(uint8_t zone);
+	
+	// arms the loopback timer of the zone for the sequence, polling the service or bounding the wait for a response
+	void
+	arm_loopback_timer(uint8_t zone, std::chrono::nanoseconds delay, uint64_t sequence, bool timedOut);
+	
+	// polls the service again or gives up on the request in flight, unless the timer is stale
+	void
+	loopback_set_temperature_timer_callback(uint8_t zone);
+	
+	// makes the goal the active one of its zone, called with the goal mutex held
+	void
+	activate_set_temperature_goal(uint8_t zone, const std::shared_ptr<TemperatureGoal> &goal);
+	
+	// takes the current target of the active goal of the zone, called with the goal mutex held
+	void
+	start_set_temperature_target(uint8_t zone);
+	
+	// holds the reached target of the active goal, then moves on to its next target
+	// returns true once the goal has no target left, called with the goal mutex held
+	bool
+	set_temperature_target_reached(uint8_t zone);
+	
+	// time to wait before checking the hold of the active goal again, at most 100ms, called with the goal mutex held
+	std::chrono::milliseconds
+	set_temperature_hold_remaining(uint8_t zone) const;
+	
+	// ends a goal of the zone with the status and counts its outcome, active or queued
+	void
+	finish_set_temperature_goal(uint8_t zone, const std::shared_ptr<TemperatureGoal> &goal, GoalStatus status,
+	                            short temperature);
+	
+	// ends the active goal of the zone with the status, called with the goal mutex held
+	void
+	complete_active_set_temperature_goal(uint8_t zone, GoalStatus status, short temperature);
+	
+	// ends the active and queued goals of every zone with the status, called with the goal mutex held
+	void
+	end_set_temperature_goals(GoalStatus status);
+	
+	// ends the active goal and activates the next queued one, returns false once no goal is left
+	bool
+	finish_active_set_temperature_goal(uint8_t zone, GoalStatus status, short temperature);
+	
+	// signed step of the active goal from the temperature, called with the goal mutex held
+	short
+	set_temperature_step(uint8_t zone, short temperature) const;
+	
+	// progress of the active goal in percent, clamped to 0..100, called with the goal mutex held
+	int
+	set_temperature_progress(uint8_t zone, short temperature) const;
+	
+	// publishes the progress of the active goal unless throttled, called with the goal mutex held
+	void
+	publish_set_temperature_feedback(uint8_t zone, short temperature);
+	
+	// estimated seconds left for the active goal of the zone, called with the goal mutex held
+	double
+	set_temperature_time_remaining(uint8_t zone, short temperature) const;
+	
+	// creates a timer of the actuation callback group, not armed until arm_one_shot_timer
+	template<class Callback>
+	rclcpp::TimerBase::SharedPtr
+	create_one_shot_timer(Callback &&callback);
+	
+	// re-arms the timer to run once after the delay, returns the node clock time it is due
+	int64_t
+	arm_one_shot_timer(const rclcpp::TimerBase::SharedPtr &timer, std::chrono::nanoseconds delay);
+	
+	// runs the next stepper iteration of the zone after the delay
+	void
+	schedule_set_temperature_step(uint8_t zone, std::chrono::milliseconds delay);
+	
+	// one iteration of the set temperature stepper of the zone
+	void
+	set_temperature_stepper_callback(uint8_t zone);
+	
+	// integrates the temperature model of every zone over one time step
+	void
+	temperature_model_update_callback();
+	
+	// runs the PID controller of every zone and commands the actuators
+	void
+	control_callback();
+	
+	// power of the actuator of the zone driving it to its setpoint
+	double
+	temperature_model_power(uint8_t zone);
+	
+	// sends the power to the actuator of the zone unless it barely changed
+	void
+	command_actuator_power(uint8_t zone, double power);
+	
+	// publishes the feedback and ends the active goal of the zone once it is reached, called with the goal mutex held
+	void
+	update_temperature_model_goal(uint8_t zone, short temperature, bool changed);
+	
+	// publishes the counters and latency histograms
+	void
+	publish_diagnostics();
+};
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_SYSTEMS_CONTROLLER_HPP_
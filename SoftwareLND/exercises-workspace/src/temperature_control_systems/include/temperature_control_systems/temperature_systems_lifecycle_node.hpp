@@ -0,0 +1,60 @@
+#ifndef TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_SYSTEMS_LIFECYCLE_NODE_HPP_
+#define TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_SYSTEMS_LIFECYCLE_NODE_HPP_
+
+#include <future>
+#include <memory>
+#include <thread>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+
+#include "temperature_control_systems/temperature_systems_controller.hpp"
+
+// lifecycle variant of the controller, configuring creates its entities, activating and deactivating pauses them
+// the controller is a node of its own, named after this one with a "_controller" suffix, spun on its own threads
+class TemperatureSystemsLifecycleNode : public rclcpp_lifecycle::LifecycleNode {
+public:
+	using CallbackReturn = rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn;
+
+private:
+	// controller created by the configuration, none while unconfigured
+	std::shared_ptr<TemperatureSystemsControllerNode> controller;
+	// executor spinning the controller, the lifecycle services stay responsive during its callbacks
+	std::shared_ptr<rclcpp::executors::MultiThreadedExecutor> controllerExecutor;
+	// thread spinning the controller executor
+	std::thread controllerThread;
+	// set once the controller executor stopped spinning
+	std::future<void> controllerSpinDone;
+
+public:
+	explicit TemperatureSystemsLifecycleNode(const rclcpp::NodeOptions &options = rclcpp::NodeOptions());
+	
+	~TemperatureSystemsLifecycleNode() override;
+	
+	// creates the controller and its entities, deactivated, and starts spinning it
+	CallbackReturn
+	on_configure(const rclcpp_lifecycle::State &state) override;
+	
+	// resumes the timers and admits goals and commands again
+	CallbackReturn
+	on_activate(const rclcpp_lifecycle::State &state) override;
+	
+	// pauses the timers and ends the goals, the entities stay in place for a fast activation
+	CallbackReturn
+	on_deactivate(const rclcpp_lifecycle::State &state) override;
+	
+	// destroys the controller and its entities
+	CallbackReturn
+	on_cleanup(const rclcpp_lifecycle::State &state) override;
+	
+	// destroys the controller from any state
+	CallbackReturn
+	on_shutdown(const rclcpp_lifecycle::State &state) override;
+
+private:
+	// stops spinning the controller and destroys it, nothing happens without a controller
+	void
+	destroy_controller();
+};
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS__TEMPERATURE_SYSTEMS_LIFECYCLE_NODE_HPP_
@@ -0,0 +1,21 @@
+#ifndef TEMPERATURE_CONTROL_SYSTEMS__TRACING_HPP_
+#define TEMPERATURE_CONTROL_SYSTEMS__TRACING_HPP_
+
+#include <cstdint>
+
+// fires an LTTng tracepoint of the controller provider, the arguments are not even evaluated without tracing
+#ifdef TEMPERATURE_CONTROL_SYSTEMS_TRACING
+#include "temperature_control_systems/tracing_provider.h"
+#define TEMPERATURE_CONTROL_TRACEPOINT(event, ...) tracepoint(temperature_control_systems, event, __VA_ARGS__)
+#else
+#define TEMPERATURE_CONTROL_TRACEPOINT(event, ...) ((void) 0)
+#endif
+
+// key of an object in the trace events
+template<class T>
+inline uint64_t
+trace_id(const T *object) {
+	return (uint64_t) (uintptr_t) object;
+}
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS__TRACING_HPP_
@@ -0,0 +1,174 @@
+// LTTng-UST tracepoint provider of the controller, only built with TEMPERATURE_CONTROL_SYSTEMS_TRACING
+// the events are keyed by zone, goals by the address of their TemperatureGoal, requests by their response
+#undef TRACEPOINT_PROVIDER
+#define TRACEPOINT_PROVIDER temperature_control_systems
+
+#undef TRACEPOINT_INCLUDE
+#define TRACEPOINT_INCLUDE "temperature_control_systems/tracing_provider.h"
+
+#if !defined(TEMPERATURE_CONTROL_SYSTEMS__TRACING_PROVIDER_H_) || defined(TRACEPOINT_HEADER_MULTI_READ)
+#define TEMPERATURE_CONTROL_SYSTEMS__TRACING_PROVIDER_H_
+
+#include <stdint.h>
+
+#include <lttng/tracepoint.h>
+
+// a goal was admitted or rejected by the action server
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	goal_handled,
+	TP_ARGS(uint8_t, zone, int, accepted),
+	TP_FIELDS(
+		ctf_integer(uint8_t, zone, zone)
+		ctf_integer(int, accepted, accepted)
+	)
+)
+
+// an admitted goal was handed to the engine of its zone
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	goal_accepted,
+	TP_ARGS(uint64_t, goal_id, uint8_t, zone, int16_t, target),
+	TP_FIELDS(
+		ctf_integer_hex(uint64_t, goal_id, goal_id)
+		ctf_integer(uint8_t, zone, zone)
+		ctf_integer(int16_t, target, target)
+	)
+)
+
+// a goal ended with one of the GoalStatus values
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	goal_finished,
+	TP_ARGS(uint64_t, goal_id, uint8_t, zone, uint8_t, status),
+	TP_FIELDS(
+		ctf_integer_hex(uint64_t, goal_id, goal_id)
+		ctf_integer(uint8_t, zone, zone)
+		ctf_integer(uint8_t, status, status)
+	)
+)
+
+// the stepper of the zone armed its one shot timer
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	step_scheduled,
+	TP_ARGS(uint8_t, zone, int64_t, delay_ms),
+	TP_FIELDS(
+		ctf_integer(uint8_t, zone, zone)
+		ctf_integer(int64_t, delay_ms, delay_ms)
+	)
+)
+
+// the executor dispatched the stepper of the zone
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	step_started,
+	TP_ARGS(uint8_t, zone),
+	TP_FIELDS(
+		ctf_integer(uint8_t, zone, zone)
+	)
+)
+
+// a step was commanded to the actuator, its simulated delay starts
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	actuation_commanded,
+	TP_ARGS(uint8_t, zone, int16_t, delta),
+	TP_FIELDS(
+		ctf_integer(uint8_t, zone, zone)
+		ctf_integer(int16_t, delta, delta)
+	)
+)
+
+// the simulated delay of the step elapsed and the temperature moved
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	actuation_applied,
+	TP_ARGS(uint8_t, zone, int16_t, temperature),
+	TP_FIELDS(
+		ctf_integer(uint8_t, zone, zone)
+		ctf_integer(int16_t, temperature, temperature)
+	)
+)
+
+// the feedback of the active goal of the zone is being published
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	feedback_publish_begin,
+	TP_ARGS(uint8_t, zone, int16_t, progress),
+	TP_FIELDS(
+		ctf_integer(uint8_t, zone, zone)
+		ctf_integer(int16_t, progress, progress)
+	)
+)
+
+// the feedback was handed to the middleware
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	feedback_publish_end,
+	TP_ARGS(uint8_t, zone),
+	TP_FIELDS(
+		ctf_integer(uint8_t, zone, zone)
+	)
+)
+
+// the loopback of the zone sent an increment/decrement request
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	loopback_request,
+	TP_ARGS(uint8_t, zone, uint64_t, sequence),
+	TP_FIELDS(
+		ctf_integer(uint8_t, zone, zone)
+		ctf_integer(uint64_t, sequence, sequence)
+	)
+)
+
+// the loopback of the zone took the response of its request
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	loopback_response,
+	TP_ARGS(uint8_t, zone, uint64_t, sequence),
+	TP_FIELDS(
+		ctf_integer(uint8_t, zone, zone)
+		ctf_integer(uint64_t, sequence, sequence)
+	)
+)
+
+// the executor dispatched an increment/decrement request
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	actuation_request,
+	TP_ARGS(uint64_t, request_id, uint8_t, zone, int, increment, int16_t, delta),
+	TP_FIELDS(
+		ctf_integer_hex(uint64_t, request_id, request_id)
+		ctf_integer(uint8_t, zone, zone)
+		ctf_integer(int, increment, increment)
+		ctf_integer(int16_t, delta, delta)
+	)
+)
+
+// the simulated delay of an accepted increment/decrement request starts
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	actuation_delay,
+	TP_ARGS(uint64_t, request_id, int64_t, delay_ms),
+	TP_FIELDS(
+		ctf_integer_hex(uint64_t, request_id, request_id)
+		ctf_integer(int64_t, delay_ms, delay_ms)
+	)
+)
+
+// the response of an increment/decrement request is sent
+TRACEPOINT_EVENT(
+	temperature_control_systems,
+	actuation_response,
+	TP_ARGS(uint64_t, request_id, int, success),
+	TP_FIELDS(
+		ctf_integer_hex(uint64_t, request_id, request_id)
+		ctf_integer(int, success, success)
+	)
+)
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS__TRACING_PROVIDER_H_
+
+#include <lttng/tracepoint-event.h>
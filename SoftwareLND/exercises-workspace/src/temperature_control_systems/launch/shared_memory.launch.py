@@ -0,0 +1,30 @@
+"""Runs the controller with zero copy telemetry for colocated subscribers.
+
+Starts the iceoryx RouDi daemon and the controller on Cyclone DDS with shared memory enabled.
+Subscribers in other processes need the same RMW_IMPLEMENTATION and CYCLONEDDS_URI to read the
+telemetry from shared memory, otherwise they fall back to UDP. Needs rmw_cyclonedds_cpp built with
+iceoryx support and the iox-roudi executable.
+"""
+
+import os
+
+from ament_index_python.packages import get_package_share_directory
+from launch import LaunchDescription
+from launch.actions import ExecuteProcess, SetEnvironmentVariable, TimerAction
+from launch_ros.actions import Node
+
+
+def generate_launch_description():
+    config = os.path.join(get_package_share_directory('temperature_control_systems'), 'config')
+    return LaunchDescription([
+        SetEnvironmentVariable('RMW_IMPLEMENTATION', 'rmw_cyclonedds_cpp'),
+        SetEnvironmentVariable('CYCLONEDDS_URI', 'file://' + os.path.join(config, 'cyclonedds_shm.xml')),
+        ExecuteProcess(cmd=['iox-roudi', '-c', os.path.join(config, 'roudi.toml')], output='screen'),
+        # give RouDi time to create the memory pools, Cyclone DDS falls back to UDP without it
+        TimerAction(period=1.0, actions=[
+            Node(package='temperature_control_systems',
+                 executable='temperature_systems_controller',
+                 parameters=[{'telemetry_qos_durability': 'volatile'}],
+                 output='screen'),
+        ]),
+    ])
@@ -0,0 +1,42 @@
+"""Runs the controller inside an LTTng session recording its tracepoints and the ROS 2 ones.
+
+Needs the controller built with -DTEMPERATURE_CONTROL_SYSTEMS_TRACING=ON, LTTng and ros2_tracing.
+The trace is written to <base_path>/<session_name>, the per stage latencies are then printed by
+  ros2 run temperature_control_systems analyze_trace.py <base_path>/<session_name>
+Controller parameters are given as usual, e.g. params_file:=rover.yaml.
+"""
+
+import os
+
+from launch import LaunchDescription
+from launch.actions import DeclareLaunchArgument
+from launch.conditions import IfCondition, UnlessCondition
+from launch.substitutions import LaunchConfiguration, PythonExpression
+from launch_ros.actions import Node
+from tracetools_launch.action import Trace
+
+
+def generate_launch_description():
+    params_file = LaunchConfiguration('params_file')
+    has_params_file = PythonExpression(["'", params_file, "' != ''"])
+    return LaunchDescription([
+        DeclareLaunchArgument('session_name', default_value='temperature_control_systems'),
+        DeclareLaunchArgument('base_path', default_value=os.path.join(os.path.expanduser('~'), '.ros', 'tracing')),
+        DeclareLaunchArgument('params_file', default_value='',
+                              description='parameters of the controller, none keeps the defaults'),
+        # the ROS 2 events tie the controller stages to the executor, the services and the actions
+        Trace(session_name=LaunchConfiguration('session_name'),
+              base_path=LaunchConfiguration('base_path'),
+              append_timestamp=False,
+              events_ust=['temperature_control_systems:*', 'ros2:*'],
+              events_kernel=[]),
+        Node(package='temperature_control_systems',
+             executable='temperature_systems_controller',
+             parameters=[params_file],
+             condition=IfCondition(has_params_file),
+             output='screen'),
+        Node(package='temperature_control_systems',
+             executable='temperature_systems_controller',
+             condition=UnlessCondition(has_params_file),
+             output='screen'),
+    ])
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""Breaks the latency of the set temperature pipeline down per stage from an LTTng trace.
+
+Reads a trace recorded with launch/tracing.launch.py and prints the count, mean, percentiles and
+maximum of every stage in microseconds, or a json object with --json. Stages:
+  goal accept           goal admitted by the server until handed to the engine
+  step dispatch         stepper timer due until its callback runs, the executor latency
+  simulated delay       step commanded until the temperature moved
+  feedback publish      time spent publishing one feedback
+  goal total            goal handed to the engine until it ended
+  service dispatch      loopback request sent until the service callback runs
+  service delay         simulated delay of an accepted increment/decrement request
+  service handling      service callback entry until its response is sent
+  loopback round trip   loopback request sent until its response is taken
+Service dispatch pairs the requests of a zone in order, other clients commanding the same zone
+during a loopback goal skew it. Needs the babeltrace2 python bindings.
+"""
+
+import argparse
+import collections
+import json
+import sys
+
+import bt2
+
+PROVIDER = 'temperature_control_systems:'
+STAGES = [
+    'goal accept', 'step dispatch', 'simulated delay', 'feedback publish', 'goal total',
+    'service dispatch', 'service delay', 'service handling', 'loopback round trip',
+]
+
+
+class StageLatencies:
+    """Pairs the begin and end events of every stage and collects their latencies."""
+
+    def __init__(self):
+        self.pending = collections.defaultdict(collections.deque)
+        self.latencies = collections.defaultdict(list)
+
+    def begin(self, stage, key, stamp, offset=0):
+        self.pending[(stage, key)].append((stamp, offset))
+
+    def end(self, stage, key, stamp):
+        pending = self.pending.get((stage, key))
+        if not pending:
+            return
+        begin, offset = pending.popleft()
+        self.latencies[stage].append(max(stamp - begin - offset, 0))
+
+    def drop(self, stage, key):
+        self.pending.pop((stage, key), None)
+
+
+def percentile(samples, quantile):
+    return samples[min(int(quantile * len(samples)), len(samples) - 1)]
+
+
+def analyze(trace_path):
+    stages = StageLatencies()
+    for message in bt2.TraceCollectionMessageIterator(trace_path):
+        if type(message) is not bt2._EventMessageConst:
+            continue
+        event = message.event
+        if not event.name.startswith(PROVIDER):
+            continue
+        name = event.name[len(PROVIDER):]
+        stamp = message.default_clock_snapshot.ns_from_origin
+        fields = event.payload_field
+        # goal and request ids are addresses, only unique within a process
+        try:
+            process = int(event.common_context_field['vpid'])
+        except (KeyError, TypeError):
+            process = 0
+        zone = (process, int(fields['zone'])) if 'zone' in fields else None
+
+        if name == 'goal_handled':
+            if int(fields['accepted']):
+                stages.begin('goal accept', zone, stamp)
+        elif name == 'goal_accepted':
+            stages.end('goal accept', zone, stamp)
+            stages.begin('goal total', (process, int(fields['goal_id'])), stamp)
+        elif name == 'goal_finished':
+            stages.end('goal total', (process, int(fields['goal_id'])), stamp)
+            # a step left pending by a cancelled or preempted goal never completes
+            stages.drop('simulated delay', zone)
+        elif name == 'step_scheduled':
+            # the timer is due after its delay, only the time past it is the executor latency
+            stages.begin('step dispatch', zone, stamp, int(fields['delay_ms']) * 1000000)
+        elif name == 'step_started':
+            stages.end('step dispatch', zone, stamp)
+        elif name == 'actuation_commanded':
+            stages.begin('simulated delay', zone, stamp)
+        elif name == 'actuation_applied':
+            stages.end('simulated delay', zone, stamp)
+        elif name == 'feedback_publish_begin':
+            stages.begin('feedback publish', zone, stamp)
+        elif name == 'feedback_publish_end':
+            stages.end('feedback publish', zone, stamp)
+        elif name == 'loopback_request':
+            stages.begin('service dispatch', zone, stamp)
+            stages.begin('loopback round trip', zone + (int(fields['sequence']),), stamp)
+        elif name == 'loopback_response':
+            stages.end('loopback round trip', zone + (int(fields['sequence']),), stamp)
+        elif name == 'actuation_request':
+            stages.end('service dispatch', zone, stamp)
+            stages.begin('service handling', (process, int(fields['request_id'])), stamp)
+        elif name == 'actuation_delay':
+            stages.begin('service delay', (process, int(fields['request_id'])), stamp)
+        elif name == 'actuation_response':
+            request = (process, int(fields['request_id']))
+            stages.end('service delay', request, stamp)
+            stages.end('service handling', request, stamp)
+    return stages.latencies
+
+
+def summarize(latencies):
+    summary = {}
+    for stage in STAGES:
+        samples = sorted(latencies.get(stage, []))
+        if not samples:
+            continue
+        summary[stage] = {
+            'count': len(samples),
+            'mean_us': sum(samples) / len(samples) / 1000.0,
+            'p50_us': percentile(samples, 0.5) / 1000.0,
+            'p90_us': percentile(samples, 0.9) / 1000.0,
+            'p99_us': percentile(samples, 0.99) / 1000.0,
+            'max_us': samples[-1] / 1000.0,
+        }
+    return summary
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Per stage latencies of the set temperature pipeline.')
+    parser.add_argument('trace', help='directory of the trace, e.g. ~/.ros/tracing/temperature_control_systems')
+    parser.add_argument('--json', action='store_true', help='print the summary as json')
+    arguments = parser.parse_args()
+
+    summary = summarize(analyze(arguments.trace))
+    if arguments.json:
+        json.dump(summary, sys.stdout, indent=2)
+        print()
+        return 0
+    if not summary:
+        print('No temperature_control_systems events, was the controller built with tracing?', file=sys.stderr)
+        return 1
+    columns = ['count', 'mean_us', 'p50_us', 'p90_us', 'p99_us', 'max_us']
+    print(f"{'stage':<20}" + ''.join(f'{column:>12}' for column in columns))
+    for stage, values in summary.items():
+        print(f'{stage:<20}{values["count"]:>12}' +
+              ''.join(f'{values[column]:>12.1f}' for column in columns[1:]))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
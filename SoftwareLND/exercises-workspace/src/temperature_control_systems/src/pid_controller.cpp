@@ -0,0 +1,38 @@
+#include "temperature_control_systems/pid_controller.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+PidController::PidController(double proportionalGain, double integralGain, double derivativeGain,
+                             double outputMin, double outputMax)
+	: proportionalGain(proportionalGain),
+	  integralGain(integralGain),
+	  derivativeGain(derivativeGain),
+	  outputMin(std::min(outputMin, outputMax)),
+	  outputMax(std::max(outputMin, outputMax)) {
+}
+
+double
+PidController::update(double setpoint, double measurement, double timeStep, double feedForward) {
+	auto error = setpoint - measurement;
+	auto derivative = started && timeStep > 0.0 ? (measurement - lastMeasurement) / timeStep : 0.0;
+	lastMeasurement = measurement;
+	started = true;
+	
+	// integrate unless the output is already saturated in the direction of the error
+	auto integralStep = integralGain * error * timeStep;
+	auto output = feedForward + proportionalGain * error + integral + integralStep - derivativeGain * derivative;
+	if (!(output > outputMax && error > 0.0) && !(output < outputMin && error < 0.0)) {
+		integral += integralStep;
+	}
+	output = feedForward + proportionalGain * error + integral - derivativeGain * derivative;
+	return std::min(std::max(output, outputMin), outputMax);
+}
+
+void
+PidController::reset() {
+	integral = 0.0;
+	lastMeasurement = 0.0;
+	started = false;
+}
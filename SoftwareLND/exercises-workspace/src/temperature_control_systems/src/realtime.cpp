@@ -0,0 +1,62 @@
+#include "temperature_control_systems/realtime.hpp"
+
+#include <alloca.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+bool
+lock_process_memory(std::string &error) {
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+		error = string("mlockall failed: ") + strerror(errno);
+		return false;
+	}
+	return true;
+}
+
+void
+prefault_stack(size_t size) {
+	// volatile keeps the compiler from dropping the writes, one per page is enough
+	auto *stack = static_cast<volatile unsigned char *>(alloca(size));
+	for (size_t offset = 0; offset < size; offset += 4096) {
+		stack[offset] = 0;
+	}
+}
+
+bool
+configure_realtime_thread(const std::string &name, int priority, const std::vector<int64_t> &cpus,
+                          std::string &error) {
+	bool success = true;
+	// thread names are limited to 15 characters
+	pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+	if (priority > 0) {
+		sched_param parameters{};
+		parameters.sched_priority = std::min(priority, sched_get_priority_max(SCHED_FIFO));
+		auto result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters);
+		if (result != 0) {
+			error = "SCHED_FIFO priority " + to_string(priority) + " failed: " + strerror(result);
+			success = false;
+		}
+	}
+	if (!cpus.empty()) {
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		for (auto cpu : cpus) {
+			if (cpu >= 0 && cpu < CPU_SETSIZE) {
+				CPU_SET((int) cpu, &cpuSet);
+			}
+		}
+		auto result = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+		if (result != 0) {
+			error += string(error.empty() ? "" : ", ") + "pinning failed: " + strerror(result);
+			success = false;
+		}
+	}
+	return success;
+}
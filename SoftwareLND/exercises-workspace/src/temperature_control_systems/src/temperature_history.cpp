@@ -0,0 +1,82 @@
+#include "temperature_control_systems/temperature_history.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+TemperatureHistory::TemperatureHistory(size_t capacity, size_t zoneCount)
+	: capacity(std::max<size_t>(capacity, 1)),
+	  zoneCount(zoneCount),
+	  stamps(this->capacity),
+	  temperatures(this->capacity * zoneCount) {
+}
+
+short *
+TemperatureHistory::append(int64_t stamp) {
+	auto row = next;
+	stamps[row] = stamp;
+	next = (next + 1) % capacity;
+	size = std::min(size + 1, capacity);
+	return &temperatures[row * zoneCount];
+}
+
+TemperatureHistory::Statistics
+TemperatureHistory::statistics(size_t zone, int64_t since) const {
+	Statistics statistics;
+	int64_t sum = 0;
+	for (auto position = first_since(since); position < size; position++) {
+		auto temperature = temperatures[slot(position) * zoneCount + zone];
+		if (statistics.count == 0 || temperature < statistics.min) {
+			statistics.min = temperature;
+		}
+		if (statistics.count == 0 || temperature > statistics.max) {
+			statistics.max = temperature;
+		}
+		sum += temperature;
+		statistics.count++;
+	}
+	statistics.mean = statistics.count == 0 ? 0.0 : (double) sum / (double) statistics.count;
+	return statistics;
+}
+
+void
+TemperatureHistory::compact(size_t zone, int64_t since, size_t maxSamples,
+                            std::vector<int64_t> &compactedStamps, std::vector<float> &compactedTemperatures) const {
+	auto first = first_since(since);
+	auto count = size - first;
+	auto groups = std::min(count, maxSamples);
+	compactedStamps.resize(groups);
+	compactedTemperatures.resize(groups);
+	// spread the samples evenly over the groups
+	for (size_t group = 0; group < groups; group++) {
+		auto begin = first + group * count / groups;
+		auto end = first + (group + 1) * count / groups;
+		int64_t sum = 0;
+		for (auto position = begin; position < end; position++) {
+			sum += temperatures[slot(position) * zoneCount + zone];
+		}
+		compactedStamps[group] = stamps[slot(end - 1)];
+		compactedTemperatures[group] = (float) sum / (float) (end - begin);
+	}
+}
+
+size_t
+TemperatureHistory::first_since(int64_t since) const {
+	// the stamps grow from the oldest sample, binary search over the positions
+	size_t low = 0;
+	size_t high = size;
+	while (low < high) {
+		auto middle = low + (high - low) / 2;
+		if (stamps[slot(middle)] < since) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+size_t
+TemperatureHistory::slot(size_t position) const {
+	return (next + capacity - size + position) % capacity;
+}
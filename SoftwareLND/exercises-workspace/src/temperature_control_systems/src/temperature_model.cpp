@@ -0,0 +1,47 @@
+#include "temperature_control_systems/temperature_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+FirstOrderTemperatureModel::FirstOrderTemperatureModel(double ambientTemperature, double timeConstant,
+                                                       double heatingRate, double maxPower)
+	: ambientTemperature(ambientTemperature),
+	  timeConstant(std::max(timeConstant, 1e-3)),
+	  heatingRate(std::max(heatingRate, 0.0)),
+	  maxPower(std::min(std::max(maxPower, 0.0), 1.0)) {
+}
+
+double
+FirstOrderTemperatureModel::step(double temperature, double power, double timeStep) const {
+	// exact solution over the step, stable whatever the step and the time constant
+	auto settled = equilibrium(power);
+	return settled + (temperature - settled) * exp(-timeStep / timeConstant);
+}
+
+double
+FirstOrderTemperatureModel::rate(double temperature, double power) const {
+	return (equilibrium(power) - temperature) / timeConstant;
+}
+
+double
+FirstOrderTemperatureModel::time_to_target(double temperature, double target) const {
+	if (target == temperature) {
+		return 0.0;
+	}
+	// full power towards the target, the temperature closes in on the equilibrium exponentially
+	auto settled = equilibrium(target > temperature ? 1.0 : -1.0);
+	auto remaining = (target - settled) / (temperature - settled);
+	if (remaining <= 0.0 || remaining >= 1.0) {
+		return numeric_limits<double>::infinity();
+	}
+	return -timeConstant * log(remaining);
+}
+
+double
+FirstOrderTemperatureModel::equilibrium(double power) const {
+	auto clampedPower = std::min(std::max(power, -1.0), 1.0);
+	return ambientTemperature + heatingRate * maxPower * clampedPower * timeConstant;
+}
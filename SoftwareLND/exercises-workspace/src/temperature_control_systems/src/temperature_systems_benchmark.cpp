@@ -0,0 +1,363 @@
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "temperature_control_systems/latency_histogram.hpp"
+#include "temperature_control_systems/temperature_systems_controller.hpp"
+
+using namespace std;
+
+namespace {
+// latency summary of a histogram as a json object
+string
+latency_json(const LatencyHistogram &histogram) {
+	ostringstream json;
+	json << "{\"count\": " << histogram.samples()
+	     << ", \"mean_us\": " << histogram.mean_us()
+	     << ", \"p50_us\": " << histogram.percentile_us(0.50)
+	     << ", \"p90_us\": " << histogram.percentile_us(0.90)
+	     << ", \"p99_us\": " << histogram.percentile_us(0.99)
+	     << ", \"max_us\": " << histogram.max_us() << "}";
+	return json.str();
+}
+
+// controller run by the benchmark in its process, spun on an executor of its own
+class InProcessController {
+	// controller being measured
+	shared_ptr<TemperatureSystemsControllerNode> controller;
+	// executor spinning only the controller, none of its callbacks runs once the spin returned
+	rclcpp::executors::MultiThreadedExecutor executor;
+	// thread spinning the executor
+	thread spinner;
+	// set once the executor stopped spinning
+	future<void> spinDone;
+
+public:
+	InProcessController(const rclcpp::NodeOptions &options, size_t threads)
+		: controller(std::make_shared<TemperatureSystemsControllerNode>(options)),
+		  executor(rclcpp::ExecutorOptions(), threads) {
+		executor.add_node(controller);
+		promise<void> spinPromise;
+		spinDone = spinPromise.get_future();
+		spinner = thread([this, spinPromise = std::move(spinPromise)]() mutable {
+			executor.spin();
+			spinPromise.set_value();
+		});
+	}
+	
+	// the controller is destroyed once nothing can run against it anymore
+	~InProcessController() {
+		// a cancel arriving before the thread started spinning is lost, repeat it until the spin returns
+		do {
+			executor.cancel();
+		} while (spinDone.wait_for(10ms) != future_status::ready);
+		spinner.join();
+	}
+};
+}
+
+// load generator driving the services, the action and the telemetry of the controller
+class TemperatureSystemsBenchmarkNode : public rclcpp::Node {
+public:
+	using GetCurrentTemperature = TemperatureSystemsControllerNode::GetCurrentTemperature;
+	using IncrementDecrementTemperature = TemperatureSystemsControllerNode::IncrementDecrementTemperature;
+	using IncrementDecrementTemperatureCompact = TemperatureSystemsControllerNode::IncrementDecrementTemperatureCompact;
+	using SetTemperature = TemperatureSystemsControllerNode::SetTemperature;
+	using SetTemperatureCompact = TemperatureSystemsControllerNode::SetTemperatureCompact;
+
+private:
+	// context prefix of the controller, the same parameter as the controller's
+	std::string contextPrefix = "temperature_control_systems";
+	// whether the controller serves the verbose interfaces, the compact ones are measured otherwise
+	bool verboseInterfaces = true;
+	// number of concurrent service clients
+	size_t clientCount = 4;
+	// number of get temperature requests sent by every client
+	size_t readRequestsPerClient = 200;
+	// number of increment/decrement requests sent by every client
+	size_t actuationRequestsPerClient = 20;
+	// distances between the current and the target temperature of the goals
+	std::vector<int64_t> goalDeltas;
+	// number of goals sent for every distance
+	size_t goalsPerDelta = 2;
+	// step size of the goals
+	short goalStepSize = 1;
+	// bound on waiting for a service, the action server or a goal response
+	std::chrono::milliseconds serviceTimeout{5000};
+	// bound on waiting for the result of a goal
+	std::chrono::nanoseconds goalTimeout{std::chrono::seconds(60)};
+	// time spent measuring the telemetry at every rate
+	std::chrono::nanoseconds jitterDuration{std::chrono::seconds(5)};
+	// callback group of the clients, responses are handled in parallel
+	rclcpp::CallbackGroup::SharedPtr clientCallbackGroup;
+
+public:
+	TemperatureSystemsBenchmarkNode() : Node("temperature_systems_benchmark") {
+		// run the controller in this process, its parameters are taken from the command line
+		this->declare_parameter<bool>("in_process_controller", true);
+		contextPrefix = this->declare_parameter<string>("context_prefix", contextPrefix);
+		verboseInterfaces = this->declare_parameter<bool>("verbose_interfaces", verboseInterfaces);
+		// threads of the executor spinning the benchmark and the in process controller, 0 uses one per core
+		this->declare_parameter<int>("executor_threads", 0);
+		clientCount = (size_t) std::max(1, this->declare_parameter<int>("clients", 4));
+		readRequestsPerClient = (size_t) std::max(0, this->declare_parameter<int>("read_requests_per_client", 200));
+		actuationRequestsPerClient = (size_t) std::max(
+				0, this->declare_parameter<int>("actuation_requests_per_client", 20));
+		goalDeltas = this->declare_parameter<vector<int64_t>>("goal_deltas", {1, 5, 10});
+		goalsPerDelta = (size_t) std::max(0, this->declare_parameter<int>("goals_per_delta", 2));
+		goalStepSize = (short) std::max(1, this->declare_parameter<int>("goal_step_size", 1));
+		// telemetry rates measured against an in process controller, only the first one otherwise
+		this->declare_parameter<vector<double>>("publish_rates_hz", {1.0, 100.0, 1000.0});
+		serviceTimeout = chrono::milliseconds(this->declare_parameter<int>("service_timeout_ms", 5000));
+		goalTimeout = chrono::duration_cast<chrono::nanoseconds>(
+				chrono::duration<double>(this->declare_parameter<double>("goal_timeout_s", 60.0)));
+		jitterDuration = chrono::duration_cast<chrono::nanoseconds>(
+				chrono::duration<double>(this->declare_parameter<double>("jitter_duration_s", 5.0)));
+		clientCallbackGroup = this->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+	}
+	
+	// round trip latency of the get temperature service under concurrent clients
+	string
+	run_read_benchmark() {
+		return run_service_benchmark<GetCurrentTemperature>(
+				"__get_current_temperature", readRequestsPerClient,
+				[](size_t, GetCurrentTemperature::Request &request) { request.zone = 0; });
+	}
+	
+	// throughput of the increment/decrement service under concurrent clients
+	string
+	run_actuation_benchmark() {
+		if (verboseInterfaces) {
+			return run_actuation_benchmark<IncrementDecrementTemperature>("__increment_decrement_temperature");
+		}
+		return run_actuation_benchmark<IncrementDecrementTemperatureCompact>(
+				"__increment_decrement_temperature_compact");
+	}
+	
+	// time to completion of set temperature goals for every distance
+	string
+	run_goal_benchmark() {
+		if (verboseInterfaces) {
+			return run_goal_benchmark<SetTemperature>("__set_temperature");
+		}
+		return run_goal_benchmark<SetTemperatureCompact>("__set_temperature_compact");
+	}
+	
+	// period and jitter of the temperature topic published at the rate
+	string
+	run_publish_jitter_benchmark(double rateHz) {
+		auto expectedPeriod = chrono::duration_cast<chrono::nanoseconds>(chrono::duration<double>(1.0 / rateHz));
+		// shared with the subscription callback, which may still run on an executor thread once unsubscribed
+		struct Arrivals {
+			LatencyHistogram period;
+			LatencyHistogram jitter;
+			chrono::steady_clock::time_point last;
+		};
+		auto arrivals = std::make_shared<Arrivals>();
+		auto subscription = this->create_subscription<std_msgs::msg::Int16>(
+				contextPrefix + "__temperature", 10,
+				[arrivals, expectedPeriod](std_msgs::msg::Int16::ConstSharedPtr) {
+					// the default callback group runs one arrival at a time
+					auto now = chrono::steady_clock::now();
+					if (arrivals->last != chrono::steady_clock::time_point()) {
+						auto interval = now - arrivals->last;
+						arrivals->period.record(interval);
+						arrivals->jitter.record(interval > expectedPeriod ? interval - expectedPeriod :
+						                        expectedPeriod - interval);
+					}
+					arrivals->last = now;
+				});
+		this_thread::sleep_for(jitterDuration);
+		subscription.reset();
+		
+		ostringstream json;
+		json << "{\"rate_hz\": " << rateHz
+		     << ", \"expected_period_us\": " << chrono::duration_cast<chrono::microseconds>(expectedPeriod).count()
+		     << ", \"period\": " << latency_json(arrivals->period)
+		     << ", \"jitter\": " << latency_json(arrivals->jitter) << "}";
+		return json.str();
+	}
+
+private:
+	// alternates the direction so the temperature stays around its initial value
+	template<class ServiceT>
+	string
+	run_actuation_benchmark(const string &serviceName) {
+		return run_service_benchmark<ServiceT>(
+				serviceName, actuationRequestsPerClient,
+				[](size_t index, typename ServiceT::Request &request) {
+					request.increment = index % 2 == 0;
+					request.delta = 1;
+					request.zone = 0;
+				});
+	}
+	
+	// sends the goals one after the other, starting from the current temperature
+	template<class Action>
+	string
+	run_goal_benchmark(const string &actionName) {
+		auto actionClient = rclcpp_action::create_client<Action>(this, contextPrefix + actionName, clientCallbackGroup);
+		auto readClient = this->create_client<GetCurrentTemperature>(
+				contextPrefix + "__get_current_temperature", rmw_qos_profile_services_default, clientCallbackGroup);
+		if (!actionClient->wait_for_action_server(serviceTimeout) || !readClient->wait_for_service(serviceTimeout)) {
+			RCLCPP_ERROR(this->get_logger(), "Set temperature action server is not available");
+			return "null";
+		}
+		
+		ostringstream json;
+		json << "[";
+		for (size_t deltaIndex = 0; deltaIndex < goalDeltas.size(); deltaIndex++) {
+			auto delta = goalDeltas[deltaIndex];
+			LatencyHistogram latency;
+			size_t succeeded = 0;
+			size_t failed = 0;
+			for (size_t goalIndex = 0; goalIndex < goalsPerDelta; goalIndex++) {
+				// start from the current temperature, alternating the direction
+				auto readFuture = readClient->async_send_request(std::make_shared<GetCurrentTemperature::Request>());
+				if (readFuture.wait_for(serviceTimeout) != future_status::ready) {
+					readClient->remove_pending_request(readFuture.request_id);
+					failed++;
+					continue;
+				}
+				typename Action::Goal goal;
+				goal.temperature = (short) (readFuture.get()->temperature + (goalIndex % 2 == 0 ? delta : -delta));
+				goal.step_size = goalStepSize;
+				
+				auto start = chrono::steady_clock::now();
+				auto goalFuture = actionClient->async_send_goal(goal);
+				if (goalFuture.wait_for(serviceTimeout) != future_status::ready || !goalFuture.get()) {
+					failed++;
+					continue;
+				}
+				auto resultFuture = actionClient->async_get_result(goalFuture.get());
+				if (resultFuture.wait_for(goalTimeout) != future_status::ready) {
+					actionClient->async_cancel_goal(goalFuture.get());
+					failed++;
+					continue;
+				}
+				latency.record(chrono::steady_clock::now() - start);
+				if (resultFuture.get().code == rclcpp_action::ResultCode::SUCCEEDED) {
+					succeeded++;
+				} else {
+					failed++;
+				}
+			}
+			json << (deltaIndex == 0 ? "" : ", ")
+			     << "{\"delta\": " << delta
+			     << ", \"step_size\": " << goalStepSize
+			     << ", \"succeeded\": " << succeeded
+			     << ", \"failed\": " << failed
+			     << ", \"latency\": " << latency_json(latency) << "}";
+		}
+		json << "]";
+		return json.str();
+	}
+	
+	// sends the requests from concurrent clients, each one waiting for its response before the next request
+	template<class ServiceT, class PrepareT>
+	string
+	run_service_benchmark(const string &serviceName, size_t requestsPerClient, PrepareT prepare) {
+		std::vector<typename rclcpp::Client<ServiceT>::SharedPtr> clients;
+		for (size_t clientIndex = 0; clientIndex < clientCount; clientIndex++) {
+			clients.push_back(this->create_client<ServiceT>(contextPrefix + serviceName,
+			                                                rmw_qos_profile_services_default,
+			                                                clientCallbackGroup));
+		}
+		if (!clients[0]->wait_for_service(serviceTimeout)) {
+			RCLCPP_ERROR(this->get_logger(), "Service '%s' is not available", serviceName.c_str());
+			return "null";
+		}
+		
+		LatencyHistogram latency;
+		atomic<uint64_t> succeeded{0};
+		atomic<uint64_t> timedOut{0};
+		auto start = chrono::steady_clock::now();
+		std::vector<thread> clientThreads;
+		for (size_t clientIndex = 0; clientIndex < clientCount; clientIndex++) {
+			clientThreads.emplace_back([&, clientIndex] {
+				auto &client = clients[clientIndex];
+				auto request = std::make_shared<typename ServiceT::Request>();
+				for (size_t requestIndex = 0; requestIndex < requestsPerClient; requestIndex++) {
+					prepare(requestIndex, *request);
+					auto requestStart = chrono::steady_clock::now();
+					auto future = client->async_send_request(request);
+					if (future.wait_for(serviceTimeout) != future_status::ready) {
+						client->remove_pending_request(future.request_id);
+						timedOut.fetch_add(1, memory_order_relaxed);
+						continue;
+					}
+					latency.record(chrono::steady_clock::now() - requestStart);
+					if (future.get()->success) {
+						succeeded.fetch_add(1, memory_order_relaxed);
+					}
+				}
+			});
+		}
+		for (auto &clientThread : clientThreads) {
+			clientThread.join();
+		}
+		auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		
+		ostringstream json;
+		json << "{\"clients\": " << clientCount
+		     << ", \"requests\": " << clientCount * requestsPerClient
+		     << ", \"succeeded\": " << succeeded.load()
+		     << ", \"timed_out\": " << timedOut.load()
+		     << ", \"elapsed_s\": " << elapsed
+		     << ", \"throughput_hz\": " << (elapsed > 0.0 ? (double) latency.samples() / elapsed : 0.0)
+		     << ", \"latency\": " << latency_json(latency) << "}";
+		return json.str();
+	}
+};
+
+int
+main(int argc, char *argv[]) {
+	rclcpp::init(argc, argv);
+	auto benchmark = std::make_shared<TemperatureSystemsBenchmarkNode>();
+	auto inProcessController = benchmark->get_parameter("in_process_controller").as_bool();
+	auto publishRates = benchmark->get_parameter("publish_rates_hz").as_double_array();
+	auto threads = (size_t) std::max<int64_t>(0, benchmark->get_parameter("executor_threads").as_int());
+	
+	rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), threads);
+	executor.add_node(benchmark);
+	// the controllers are replaced while the benchmark spins, each one stops its own executor first
+	unique_ptr<InProcessController> controller;
+	if (inProcessController) {
+		controller = std::make_unique<InProcessController>(rclcpp::NodeOptions(), threads);
+	}
+	thread spinner([&executor] { executor.spin(); });
+	
+	ostringstream json;
+	// the actuation and goal sections measure the verbose or the compact interfaces, whichever the controller serves
+	json << "{\"interfaces\": \"" << (benchmark->get_parameter("verbose_interfaces").as_bool() ? "verbose" : "compact")
+	     << "\", \"read\": " << benchmark->run_read_benchmark()
+	     << ", \"actuation\": " << benchmark->run_actuation_benchmark()
+	     << ", \"goals\": " << benchmark->run_goal_benchmark()
+	     << ", \"publish_jitter\": [";
+	if (inProcessController) {
+		controller.reset();
+	} else {
+		// the rate of an external controller cannot be changed, it is expected to run at the first rate
+		publishRates.resize(std::min<size_t>(publishRates.size(), 1));
+	}
+	for (size_t rateIndex = 0; rateIndex < publishRates.size(); rateIndex++) {
+		if (inProcessController) {
+			// a fresh controller for every rate, publishing on every tick
+			controller = std::make_unique<InProcessController>(
+					rclcpp::NodeOptions()
+							.append_parameter_override("telemetry_rate_hz", publishRates[rateIndex])
+							.append_parameter_override("telemetry_publish_on_change", false),
+					threads);
+		}
+		json << (rateIndex == 0 ? "" : ", ") << benchmark->run_publish_jitter_benchmark(publishRates[rateIndex]);
+		controller.reset();
+	}
+	json << "]}";
+	
+	executor.cancel();
+	spinner.join();
+	cout << json.str() << endl;
+	rclcpp::shutdown();
+	return 0;
+}
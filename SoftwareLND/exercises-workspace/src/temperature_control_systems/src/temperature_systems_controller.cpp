@@ -1,220 +1,1687 @@
-#include <random>
+#include "temperature_control_systems/temperature_systems_controller.hpp"
+#include "temperature_control_systems/realtime.hpp"
+#include "temperature_control_systems/tracing.hpp"
 
-#include "rclcpp/rclcpp.hpp"
-#include "rclcpp_action/rclcpp_action.hpp"
-#include "std_msgs/msg/int16.hpp"
+#include "rcl/timer.h"
 
-#include "temperature_control_systems_interfaces/srv/get_current_temperature.hpp"
-#include "temperature_control_systems_interfaces/srv/increment_decrement_temperature.hpp"
-#include "temperature_control_systems_interfaces/action/set_temperature.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <thread>
 
 using namespace std;
-using namespace temperature_control_systems_interfaces::srv;
-using namespace temperature_control_systems_interfaces::action;
-
-class TemperatureSystemsControllerNode : public rclcpp::Node {
-private:
-	// context prefix
-	const string contextPrefix = "temperature_control_systems";
-	// current temperature
-	short currentTemperature;
-	// timer to monitor the temperature
-	rclcpp::TimerBase::SharedPtr temperatureMonitorTimer;
-	// publisher to publish the temperature
-	rclcpp::Publisher<std_msgs::msg::Int16>::SharedPtr temperaturePublisher;
-	// service that returns the current temperature
-	rclcpp::Service<GetCurrentTemperature>::SharedPtr getCurrentTemperatureService;
-	// service that increments or decrements the current temperature
-	rclcpp::Service<IncrementDecrementTemperature>::SharedPtr incrementDecrementTemperatureService;
-	// action server to set the temperature
-	rclcpp_action::Server<SetTemperature>::SharedPtr setTemperatureActionServer;
-	// status of the action server busy or not
-	volatile bool actionServerBusy = false;
-	// thread to execute the action server
-	thread actionThread;
-	
-	// uniform random number generator
-	default_random_engine randomNumber;
 
+namespace {
+// response messages indexed by the direction of the command, they are never built per request
+const char *const actuatedMessages[] = {"Temperature decreased successfully", "Temperature increased successfully"};
+const char *const refusedMessages[] = {"Temperature cannot be decreased", "Temperature cannot be increased"};
+const char *const commandedMessages[] = {"Temperature decrease commanded", "Temperature increase commanded"};
+const char *const unknownZoneMessage = "Unknown zone";
+const char *const invalidDeltaMessage = "Delta must be positive, the direction is given by increment";
+// result messages of the verbose action indexed by the status of the goal
+const char *const goalStatusMessages[] = {"Setting temperature succeeded", "Setting temperature cancelled",
+                                          "Setting temperature preempted",
+                                          "Increment/decrement temperature service is not available",
+                                          "Increment/decrement temperature service timed out",
+                                          "Controller shutting down", "Controller deactivated"};
+
+using ActuationStatus = TemperatureSystemsControllerNode::IncrementDecrementTemperatureCompact::Response;
+static_assert((uint8_t) GoalStatus::DEACTIVATED ==
+              TemperatureSystemsControllerNode::SetTemperatureCompact::Result::STATUS_DEACTIVATED,
+              "goal statuses must match the compact result");
+
+// verbose responses carry the message when there is one, compact ones the status code
+void
+set_actuation_status(TemperatureSystemsControllerNode::IncrementDecrementTemperature::Response &response,
+                     uint8_t, const char *message) {
+	// responses are reused, clearing keeps the capacity of the message
+	if (message) {
+		response.message = message;
+	} else {
+		response.message.clear();
+	}
+}
+
+void
+set_actuation_status(TemperatureSystemsControllerNode::IncrementDecrementTemperatureCompact::Response &response,
+                     uint8_t status, const char *) {
+	response.status = status;
+}
+
+// goals of the single target actions are valid once their zone is, a schedule needs a segment
+template<class Goal>
+bool
+valid_goal(const Goal &) {
+	return true;
+}
+
+bool
+valid_goal(const TemperatureSystemsControllerNode::SetTemperatureSchedule::Goal &goal) {
+	return !goal.segments.empty();
+}
+
+// message allocated from the telemetry allocator of the publisher, intra process subscribers take it without a copy
+template<class Publisher>
+typename Publisher::MessageUniquePtr
+allocate_telemetry_message(const Publisher &publisher) {
+	using MessageAllocatorTraits = typename Publisher::MessageAllocatorTraits;
+	auto allocator = publisher.get_allocator();
+	auto message = MessageAllocatorTraits::allocate(*allocator, 1);
+	MessageAllocatorTraits::construct(*allocator, message);
+	typename Publisher::MessageDeleter deleter;
+	rclcpp::allocator::set_allocator_for_deleter(&deleter, allocator.get());
+	return typename Publisher::MessageUniquePtr(message, deleter);
+}
+}
 
-public:
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "UnusedValue"
-	
-	
-	TemperatureSystemsControllerNode() : Node("temperature_control_systems") {
-		// initialize the current temperature with random value between 15 and 100
-		currentTemperature = (short) (15 + (randomNumber() % 85));
-		// create a publisher
-		temperaturePublisher = this->create_publisher<std_msgs::msg::Int16>(contextPrefix + "__temperature", 10);
-		// create a monitor timer
-		temperatureMonitorTimer = this->create_wall_timer(1s, [this] { temperature_monitor_callback(); });
-		// create a service to return the current temperature
-		getCurrentTemperatureService = this->create_service<GetCurrentTemperature>(
-				contextPrefix + "__get_current_temperature",
-				[this](const std::shared_ptr<GetCurrentTemperature::Request> &request,
-				       const std::shared_ptr<GetCurrentTemperature::Response> &response) {
-					get_current_temperature_callback(request, response);
-				}
+
+TemperatureSystemsControllerNode::TemperatureSystemsControllerNode(const rclcpp::NodeOptions &options)
+	: TemperatureSystemsControllerNode("temperature_control_systems", "", options) {
+}
+
+TemperatureSystemsControllerNode::TemperatureSystemsControllerNode(const string &nodeName,
+                                                                   const string &nodeNamespace,
+                                                                   const rclcpp::NodeOptions &options)
+	: Node(nodeName, nodeNamespace, options) {
+	// prefix of every name served by the node, several controllers can share a namespace with their own prefix
+	contextPrefix = this->declare_parameter<string>("context_prefix", contextPrefix);
+	// "stepper" runs the action on the executor, "loopback" calls the increment/decrement service
+	auto actionMode = this->declare_parameter<string>("action_mode", "stepper");
+	actionLoopback = actionMode == "loopback";
+	if (!actionLoopback && actionMode != "stepper") {
+		RCLCPP_WARN(this->get_logger(), "Unknown action mode '%s', falling back to 'stepper'", actionMode.c_str());
+	}
+	// the compact interfaces are always served, the verbose ones carrying messages can be left out
+	verboseInterfaces = this->declare_parameter<bool>("verbose_interfaces", true);
+	if (!verboseInterfaces && actionLoopback) {
+		RCLCPP_WARN(this->get_logger(), "Loopback action mode needs the verbose interfaces, falling back to 'stepper'");
+		actionLoopback = false;
+	}
+	// goals arriving while another one runs are rejected, queued or preempt the running one
+	auto goalPolicyName = this->declare_parameter<string>("goal_policy", "reject");
+	if (goalPolicyName == "queue") {
+		goalPolicy = GoalPolicy::QUEUE;
+	} else if (goalPolicyName == "preempt") {
+		goalPolicy = GoalPolicy::PREEMPT;
+	} else if (goalPolicyName != "reject") {
+		RCLCPP_WARN(this->get_logger(), "Unknown goal policy '%s', falling back to 'reject'",
+		            goalPolicyName.c_str());
+	}
+	// feedback is published at most at this rate, zero disables the limit, both throttles can be changed live
+	auto feedbackMaxRate = this->declare_parameter<double>("feedback_max_rate_hz", 0.0);
+	if (feedbackMaxRate > 0.0) {
+		feedbackMinInterval = chrono::duration_cast<chrono::nanoseconds>(chrono::duration<double>(1.0 / feedbackMaxRate));
+	}
+	// feedback is only published once the progress moved by this many percent
+	feedbackMinProgressStep = std::max(0, this->declare_parameter<int>("feedback_min_progress_step", 0));
+	loopbackServiceTimeout = chrono::milliseconds(
+			this->declare_parameter<int>("loopback_service_timeout_ms", 5000));
+	deferredActuationResponse = this->declare_parameter<bool>("deferred_actuation_response", true);
+	// production mode: no per request logs, empty messages on success
+	quietMode = this->declare_parameter<bool>("quiet_mode", false);
+	// requests and goals asking for larger steps are moved in steps of this size
+	maxActuationStep = (short) std::max(1, this->declare_parameter<int>("max_actuation_step", 10));
+	// executor spinning the node: "single_threaded", "static_single_threaded", "multi_threaded"
+	// or "callback_group_threads", spinning every callback group on its own configurable thread
+	auto executorType = this->declare_parameter<string>("executor", "single_threaded");
+	// number of threads of the multi threaded executor, 0 uses one per core
+	this->declare_parameter<int>("executor_threads", 0);
+	// lock the process memory and prefault the stack of every executor thread before spinning
+	this->declare_parameter<bool>("lock_memory", false);
+	this->declare_parameter<int>("stack_prefault_size", 512 * 1024);
+	// SCHED_FIFO priority and cores of every callback group thread, 0 keeps the default policy, no cores every core
+	// the other executors share their threads between the groups, taking the highest priority and every core
+	this->declare_parameter<int>("actuation_thread_priority", 0);
+	this->declare_parameter<vector<int64_t>>("actuation_thread_cpus", vector<int64_t>());
+	this->declare_parameter<int>("telemetry_thread_priority", 0);
+	this->declare_parameter<vector<int64_t>>("telemetry_thread_cpus", vector<int64_t>());
+	this->declare_parameter<int>("read_thread_priority", 0);
+	this->declare_parameter<vector<int64_t>>("read_thread_cpus", vector<int64_t>());
+	// reads and telemetry never wait behind a slow actuation
+	// with a thread per callback group, the groups are handed to their executors instead of following the node
+	bool addGroupsWithNode = executorType != "callback_group_threads";
+	readCallbackGroup = this->create_callback_group(rclcpp::CallbackGroupType::Reentrant, addGroupsWithNode);
+	telemetryCallbackGroup = this->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive,
+	                                                     addGroupsWithNode);
+	actuationCallbackGroup = this->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive,
+	                                                     addGroupsWithNode);
+	// a fixed seed replays the same temperatures, refusals and delays, a negative one draws a fresh seed
+	auto randomSeed = this->declare_parameter<int>("random_seed", -1);
+	randomNumber.seed(randomSeed < 0 ? random_device()() : (uint32_t) randomSeed);
+	// actuation delays are multiplied by this scale, zero actuates at once for fast simulations
+	actuationDelayScale = std::max(0.0, this->declare_parameter<double>("actuation_delay_scale", 1.0));
+	// range of the simulated actuation delays and share of refused commands, all can be changed live
+	auto delayMin = std::max<int64_t>(0, this->declare_parameter<int>("actuation_delay_min_ms", 100));
+	auto delayMax = std::max<int64_t>(delayMin, this->declare_parameter<int>("actuation_delay_max_ms", 500));
+	actuationDelayMin = delayMin;
+	actuationDelayMax = delayMax;
+	actuationRefusalRate = std::min(std::max(this->declare_parameter<double>("actuation_refusal_rate", 0.5), 0.0), 1.0);
+	// one node serves every thermal zone, zone ids go from 0 to zone_count - 1
+	zoneCount = (size_t) std::min(std::max(1, this->declare_parameter<int>("zone_count", 1)), 256);
+	zoneTemperatures = vector<atomic<short>>(zoneCount);
+	zoneTargetTemperatures = vector<atomic<short>>(zoneCount);
+	zoneUpdateStamps = vector<atomic<int64_t>>(zoneCount);
+	zoneBusy = vector<atomic<bool>>(zoneCount);
+	zoneGoals = vector<ZoneGoals>(zoneCount);
+	// samples kept by the history, allocated once, 3600 covers an hour at the default telemetry rate, zero disables it
+	auto historyCapacity = this->declare_parameter<int>("history_capacity", 3600);
+	if (historyCapacity > 0) {
+		temperatureHistory = std::make_unique<TemperatureHistory>((size_t) historyCapacity, zoneCount);
+		historyStamps.reserve(std::min<size_t>((size_t) historyCapacity, numeric_limits<uint16_t>::max()));
+	}
+	lastPublishedZoneTemperatures = vector<short>(zoneCount);
+	// initialize the current temperatures with random values in the initial range, the maximum is excluded
+	auto initialMin = this->declare_parameter<int>("initial_temperature_min", 15);
+	auto initialMax = std::max(initialMin + 1, this->declare_parameter<int>("initial_temperature_max", 100));
+	auto startStamp = this->now().nanoseconds();
+	for (size_t zone = 0; zone < zoneCount; zone++) {
+		auto temperature = initialMin + (int) (randomNumber() % (uint32_t) (initialMax - initialMin));
+		zoneTemperatures[zone].store((short) temperature, memory_order_relaxed);
+		zoneUpdateStamps[zone].store(startStamp, memory_order_relaxed);
+	}
+	// "discrete" moves by whole steps on accepted commands, "first_order" integrates a thermal model
+	auto temperatureModelName = this->declare_parameter<string>("temperature_model", "discrete");
+	if (temperatureModelName == "first_order") {
+		temperatureModel = std::make_unique<FirstOrderTemperatureModel>(
+				this->declare_parameter<double>("model_ambient_temperature", 20.0),
+				this->declare_parameter<double>("model_time_constant_s", 120.0),
+				this->declare_parameter<double>("model_heating_rate", 2.0),
+				this->declare_parameter<double>("model_max_power", 1.0));
+	} else if (temperatureModelName != "discrete") {
+		RCLCPP_WARN(this->get_logger(), "Unknown temperature model '%s', falling back to 'discrete'",
+		            temperatureModelName.c_str());
+	}
+	// "proportional" recomputes the power on every model update, "pid" on a slower control timer
+	auto controlMode = this->declare_parameter<string>("control_mode", "proportional");
+	pidControl = controlMode == "pid" && temperatureModel;
+	if (controlMode == "pid" && !temperatureModel) {
+		RCLCPP_WARN(this->get_logger(), "PID control needs a temperature model, falling back to discrete steps");
+	} else if (controlMode != "pid" && controlMode != "proportional") {
+		RCLCPP_WARN(this->get_logger(), "Unknown control mode '%s', falling back to 'proportional'",
+		            controlMode.c_str());
+	}
+	if (temperatureModel) {
+		// rate at which the zones approach their setpoint, per degree of error
+		modelControlGain = std::max(0.0, this->declare_parameter<double>("model_control_gain", 1.0));
+		// the actuator is only commanded when its power moves by more than this
+		controlOutputDeadband = std::max(0.0, this->declare_parameter<double>("control_output_deadband", 0.01));
+		zonePowers = vector<double>(zoneCount, 0.0);
+		if (pidControl) {
+			auto controlRate = this->declare_parameter<double>("control_rate_hz", 10.0);
+			if (controlRate <= 0.0) {
+				RCLCPP_WARN(this->get_logger(), "Invalid control rate %f Hz, falling back to 10 Hz", controlRate);
+				controlRate = 10.0;
+			}
+			controlTimeStep = 1.0 / controlRate;
+			// gains in power per degree, per degree second and per degree per second
+			zonePidControllers = vector<PidController>(
+					zoneCount, PidController(this->declare_parameter<double>("pid_kp", 0.5),
+					                         this->declare_parameter<double>("pid_ki", 0.02),
+					                         this->declare_parameter<double>("pid_kd", 0.0),
+					                         -1.0, 1.0));
+		}
+		auto modelUpdateRate = this->declare_parameter<double>("model_update_rate_hz", 100.0);
+		if (modelUpdateRate <= 0.0) {
+			RCLCPP_WARN(this->get_logger(), "Invalid model update rate %f Hz, falling back to 100 Hz", modelUpdateRate);
+			modelUpdateRate = 100.0;
+		}
+		temperatureModelTimeStep = 1.0 / modelUpdateRate;
+		zoneModelTemperatures = vector<double>(zoneCount);
+		// the actuators stay off until a zone is commanded
+		zoneSetpoints = vector<double>(zoneCount, numeric_limits<double>::quiet_NaN());
+		for (size_t zone = 0; zone < zoneCount; zone++) {
+			zoneModelTemperatures[zone] = zoneTemperatures[zone].load(memory_order_relaxed);
+		}
+		// goals are tracked by the model update, which has no use for the loopback client
+		if (actionLoopback) {
+			RCLCPP_WARN(this->get_logger(), "Loopback action mode is not supported by the temperature model");
+			actionLoopback = false;
+		}
+	}
+	// publish on change, ignoring changes within the deadband, with a heartbeat after the max silence
+	telemetryPublishOnChange = this->declare_parameter<bool>("telemetry_publish_on_change", false);
+	telemetryDeadband = std::max(0, this->declare_parameter<int>("telemetry_deadband", 0));
+	telemetryMaxSilence = chrono::duration_cast<chrono::nanoseconds>(
+			chrono::duration<double>(this->declare_parameter<double>("telemetry_max_silence_s", 10.0)));
+	// create a publisher, colocated subscribers can take the messages without a copy
+	auto temperatureQos = telemetry_qos();
+	rclcpp::PublisherOptionsWithAllocator<TelemetryAllocator> temperaturePublisherOptions;
+	temperaturePublisherOptions.allocator = std::make_shared<TelemetryAllocator>();
+	if (this->declare_parameter<bool>("telemetry_intra_process", false)) {
+		temperaturePublisherOptions.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+	}
+	// intra process delivery only supports volatile durability
+	if (temperatureQos.durability() == rclcpp::DurabilityPolicy::TransientLocal) {
+		if (temperaturePublisherOptions.use_intra_process_comm == rclcpp::IntraProcessSetting::Enable) {
+			RCLCPP_WARN(this->get_logger(), "Intra process telemetry is disabled by transient local durability");
+		}
+		temperaturePublisherOptions.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+	}
+	telemetryIntraProcess =
+			temperaturePublisherOptions.use_intra_process_comm == rclcpp::IntraProcessSetting::Enable ||
+			(temperaturePublisherOptions.use_intra_process_comm == rclcpp::IntraProcessSetting::NodeDefault &&
+			 options.use_intra_process_comms());
+	temperaturePublisher = this->create_publisher<std_msgs::msg::Int16, TelemetryAllocator>(contextPrefix + "__temperature",
+	                                                                     temperatureQos,
+	                                                                     temperaturePublisherOptions);
+	// the first zone keeps its own topic, every zone is published in one message with several zones
+	if (zoneCount > 1) {
+		zoneTemperaturesPublisher = this->create_publisher<ZoneTemperatures, TelemetryAllocator>(
+				contextPrefix + "__zone_temperatures", temperatureQos, temperaturePublisherOptions);
+		zoneTemperaturesMessage.zone_count = (uint16_t) zoneCount;
+	}
+	// create a monitor timer publishing at the telemetry rate, changing the rate live rebuilds it
+	auto telemetryRate = this->declare_parameter<double>("telemetry_rate_hz", 1.0);
+	if (telemetryRate <= 0.0) {
+		RCLCPP_WARN(this->get_logger(), "Invalid telemetry rate %f Hz, falling back to 1 Hz", telemetryRate);
+		telemetryRate = 1.0;
+	}
+	create_temperature_monitor_timer(telemetryRate);
+	// integrate the model at a fixed step, serialized with the commands changing the setpoints
+	if (temperatureModel) {
+		temperatureModelTimer = rclcpp::create_timer(
+				this, this->get_clock(),
+				rclcpp::Duration(chrono::duration_cast<chrono::nanoseconds>(
+						chrono::duration<double>(temperatureModelTimeStep))),
+				[this] { temperature_model_update_callback(); },
+				actuationCallbackGroup);
+	}
+	// the controller runs slower than the plant, holding the power between its ticks
+	if (pidControl) {
+		controlTimer = rclcpp::create_timer(
+				this, this->get_clock(),
+				rclcpp::Duration(chrono::duration_cast<chrono::nanoseconds>(chrono::duration<double>(controlTimeStep))),
+				[this] { control_callback(); },
+				actuationCallbackGroup);
+	}
+	// publish the counters and latency histograms on the standard diagnostics topic, zero disables it
+	auto diagnosticsPeriod = this->declare_parameter<double>("diagnostics_period_s", 1.0);
+	if (diagnosticsPeriod > 0.0) {
+		diagnosticsPublisher = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>("/diagnostics", 10);
+		diagnosticsTimer = this->create_wall_timer(
+				chrono::duration_cast<chrono::nanoseconds>(chrono::duration<double>(diagnosticsPeriod)),
+				[this] { publish_diagnostics(); },
+				telemetryCallbackGroup);
+	}
+	// create a service to return the current temperature
+	getCurrentTemperatureService = this->create_service<GetCurrentTemperature>(
+			contextPrefix + "__get_current_temperature",
+			[this](const std::shared_ptr<GetCurrentTemperature::Request> &request,
+			       const std::shared_ptr<GetCurrentTemperature::Response> &response) {
+				get_current_temperature_callback(request, response);
+			},
+			rmw_qos_profile_services_default,
+			readCallbackGroup
+	);
+	// create a service to return the current temperatures of many zones in a single round trip
+	getZoneTemperaturesService = this->create_service<GetZoneTemperatures>(
+			contextPrefix + "__get_zone_temperatures",
+			[this](const std::shared_ptr<GetZoneTemperatures::Request> &request,
+			       const std::shared_ptr<GetZoneTemperatures::Response> &response) {
+				get_zone_temperatures_callback(request, response);
+			},
+			rmw_qos_profile_services_default,
+			readCallbackGroup
+	);
+	// create a service to return the history, serialized with the monitor filling it so no lock is needed
+	if (temperatureHistory) {
+		getTemperatureHistoryService = this->create_service<GetTemperatureHistory>(
+				contextPrefix + "__get_temperature_history",
+				[this](const std::shared_ptr<GetTemperatureHistory::Request> &request,
+				       const std::shared_ptr<GetTemperatureHistory::Response> &response) {
+					get_temperature_history_callback(request, response);
+				},
+				rmw_qos_profile_services_default,
+				telemetryCallbackGroup
 		);
-		// create a service to increment or decrement the current temperature
-		incrementDecrementTemperatureService = this->create_service<IncrementDecrementTemperature>(
-				contextPrefix + "__increment_decrement_temperature",
-				[this](const std::shared_ptr<IncrementDecrementTemperature::Request> &request,
-				       const std::shared_ptr<IncrementDecrementTemperature::Response> &response) {
-					increment_decrement_temperature_callback(request, response);
-				}
+	}
+	// create the services to increment or decrement the current temperature
+	if (deferredActuationResponse) {
+		// requests waiting for their actuation delay at once per service, the slots are allocated here
+		auto pendingActuations = (size_t) std::max<int64_t>(
+				1, this->declare_parameter<int64_t>("max_pending_actuations", 64));
+		if (verboseInterfaces) {
+			incrementDecrementTemperatureService = this->create_service<IncrementDecrementTemperature>(
+					contextPrefix + "__increment_decrement_temperature",
+					[this](const std::shared_ptr<rclcpp::Service<IncrementDecrementTemperature>> &service,
+					       const std::shared_ptr<rmw_request_id_t> &requestHeader,
+					       const std::shared_ptr<IncrementDecrementTemperature::Request> &request) {
+						increment_decrement_temperature_deferred_callback(service, requestHeader, request);
+					},
+					rmw_qos_profile_services_default,
+					actuationCallbackGroup
+			);
+			create_deferred_actuations(incrementDecrementTemperatureService, pendingActuations);
+		}
+		incrementDecrementTemperatureCompactService = this->create_service<IncrementDecrementTemperatureCompact>(
+				contextPrefix + "__increment_decrement_temperature_compact",
+				[this](const std::shared_ptr<rclcpp::Service<IncrementDecrementTemperatureCompact>> &service,
+				       const std::shared_ptr<rmw_request_id_t> &requestHeader,
+				       const std::shared_ptr<IncrementDecrementTemperatureCompact::Request> &request) {
+					increment_decrement_temperature_deferred_callback(service, requestHeader, request);
+				},
+				rmw_qos_profile_services_default,
+				actuationCallbackGroup
+		);
+		create_deferred_actuations(incrementDecrementTemperatureCompactService, pendingActuations);
+	} else {
+		if (verboseInterfaces) {
+			incrementDecrementTemperatureService = this->create_service<IncrementDecrementTemperature>(
+					contextPrefix + "__increment_decrement_temperature",
+					[this](const std::shared_ptr<IncrementDecrementTemperature::Request> &request,
+					       const std::shared_ptr<IncrementDecrementTemperature::Response> &response) {
+						increment_decrement_temperature_callback<IncrementDecrementTemperature>(request, response);
+					},
+					rmw_qos_profile_services_default,
+					actuationCallbackGroup
+			);
+		}
+		incrementDecrementTemperatureCompactService = this->create_service<IncrementDecrementTemperatureCompact>(
+				contextPrefix + "__increment_decrement_temperature_compact",
+				[this](const std::shared_ptr<IncrementDecrementTemperatureCompact::Request> &request,
+				       const std::shared_ptr<IncrementDecrementTemperatureCompact::Response> &response) {
+					increment_decrement_temperature_callback<IncrementDecrementTemperatureCompact>(request, response);
+				},
+				rmw_qos_profile_services_default,
+				actuationCallbackGroup
 		);
-		
-		// create an action server to set the temperature
+	}
+	
+	// create the client once, loopback goals share it
+	if (actionLoopback) {
+		incrementDecrementTemperatureClient = this->create_client<IncrementDecrementTemperature>(
+				contextPrefix + "__increment_decrement_temperature",
+				rmw_qos_profile_services_default,
+				readCallbackGroup);
+	}
+	// the timers of the zones are created once, every step re-arms them instead of creating one
+	for (size_t zone = 0; zone < zoneCount && !temperatureModel; zone++) {
+		if (actionLoopback) {
+			zoneGoals[zone].loopbackTimer = create_one_shot_timer(
+					[this, zone] { loopback_set_temperature_timer_callback((uint8_t) zone); });
+		} else {
+			zoneGoals[zone].stepperTimer = create_one_shot_timer(
+					[this, zone] { set_temperature_stepper_callback((uint8_t) zone); });
+		}
+	}
+	
+	// create the action servers to set the temperature, both feed the same engine
+	if (verboseInterfaces) {
 		setTemperatureActionServer = rclcpp_action::create_server<SetTemperature>(
 				this,
 				contextPrefix + "__set_temperature",
 				[this](const rclcpp_action::GoalUUID &uuid,
 				       const shared_ptr<const SetTemperature::Goal> &goal) {
-					return handle_set_temperature_action_callback(uuid, goal);
+					return handle_set_temperature_action_callback<SetTemperature>(uuid, goal);
 				},
 				[this](const shared_ptr<rclcpp_action::ServerGoalHandle<SetTemperature>> &goalHandle) {
-					return cancel_set_temperature_action_callback(goalHandle);
+					return cancel_set_temperature_action_callback<SetTemperature>(goalHandle);
 				},
 				[this](const shared_ptr<rclcpp_action::ServerGoalHandle<SetTemperature>> &goalHandle) {
-					accepted_set_temperature_action_callback(goalHandle);
-				}
+					accepted_set_temperature_action_callback(
+							std::make_shared<ActionTemperatureGoal<SetTemperature>>(goalHandle));
+				},
+				rcl_action_server_get_default_options(),
+				actuationCallbackGroup
 		);
-		
 	}
+	setTemperatureCompactActionServer = rclcpp_action::create_server<SetTemperatureCompact>(
+			this,
+			contextPrefix + "__set_temperature_compact",
+			[this](const rclcpp_action::GoalUUID &uuid,
+			       const shared_ptr<const SetTemperatureCompact::Goal> &goal) {
+				return handle_set_temperature_action_callback<SetTemperatureCompact>(uuid, goal);
+			},
+			[this](const shared_ptr<rclcpp_action::ServerGoalHandle<SetTemperatureCompact>> &goalHandle) {
+				return cancel_set_temperature_action_callback<SetTemperatureCompact>(goalHandle);
+			},
+			[this](const shared_ptr<rclcpp_action::ServerGoalHandle<SetTemperatureCompact>> &goalHandle) {
+				accepted_set_temperature_action_callback(
+						std::make_shared<ActionTemperatureGoal<SetTemperatureCompact>>(goalHandle));
+			},
+			rcl_action_server_get_default_options(),
+			actuationCallbackGroup
+	);
+	// a schedule is one goal, its segments follow each other on the same engine
+	setTemperatureScheduleActionServer = rclcpp_action::create_server<SetTemperatureSchedule>(
+			this,
+			contextPrefix + "__set_temperature_schedule",
+			[this](const rclcpp_action::GoalUUID &uuid,
+			       const shared_ptr<const SetTemperatureSchedule::Goal> &goal) {
+				return handle_set_temperature_action_callback<SetTemperatureSchedule>(uuid, goal);
+			},
+			[this](const shared_ptr<rclcpp_action::ServerGoalHandle<SetTemperatureSchedule>> &goalHandle) {
+				return cancel_set_temperature_action_callback<SetTemperatureSchedule>(goalHandle);
+			},
+			[this](const shared_ptr<rclcpp_action::ServerGoalHandle<SetTemperatureSchedule>> &goalHandle) {
+				accepted_set_temperature_action_callback(std::make_shared<ScheduleTemperatureGoal>(goalHandle));
+			},
+			rcl_action_server_get_default_options(),
+			actuationCallbackGroup
+	);
+	
+	// registered last, the declarations above are not validated against the running node
+	setParametersCallbackHandle = this->add_on_set_parameters_callback(
+			[this](const vector<rclcpp::Parameter> &parameters) {
+				return set_parameters_callback(parameters);
+			});
+}
 
 #pragma clang diagnostic pop
 
-private:
-	void
-	temperature_monitor_callback() {
-		// publish the current temperature
-		auto message = std_msgs::msg::Int16();
-		message.data = currentTemperature;
-		RCLCPP_DEBUG(this->get_logger(), "Publishing: '%s'", to_string(message.data).c_str());
-		temperaturePublisher->publish(message);
-	}
-
-private:
-	void
-	get_current_temperature_callback(
-			const std::shared_ptr<GetCurrentTemperature::Request> &request,
-			const std::shared_ptr<GetCurrentTemperature::Response> &response) {
-		RCLCPP_INFO(this->get_logger(), "Incoming request for current temperature");
-		response->temperature = currentTemperature;
-	}
-
-private:
-	void
-	increment_decrement_temperature_callback(
-			const std::shared_ptr<IncrementDecrementTemperature::Request> &request,
-			const std::shared_ptr<IncrementDecrementTemperature::Response> &response) {
-		bool isIncrement = request->increment;
-		RCLCPP_INFO(this->get_logger(), "Incoming request for %s temperature",
-		            isIncrement ? "increment" : "decrement");
-		// check if the temperature can be increased
-		bool canIncreaseTemperature = randomNumber() % 2 == 0;
-		if (!canIncreaseTemperature) {
-			response->success = false;
-			response->temperature = currentTemperature;
-			response->message = "Temperature cannot be " + string(isIncrement ? "increased" : "decreased");
+TemperatureSystemsControllerNode::~TemperatureSystemsControllerNode() {
+	// nothing may run against the node once it is gone, stop the timers and drop the requests in flight
+	lock_guard<mutex> lock(goalMutex);
+	for (auto &timer : {temperatureMonitorTimer, diagnosticsTimer, temperatureModelTimer, controlTimer,
+	                    std::get<0>(deferredActuations).timer, std::get<1>(deferredActuations).timer}) {
+		if (timer) {
+			timer->cancel();
+		}
+	}
+	if (incrementDecrementTemperatureClient) {
+		incrementDecrementTemperatureClient->prune_pending_requests();
+	}
+	// clients learn that their goals ended with the node
+	end_set_temperature_goals(GoalStatus::SHUTTING_DOWN);
+}
+
+void
+TemperatureSystemsControllerNode::set_active(bool activate) {
+	lock_guard<mutex> lock(goalMutex);
+	if (active.exchange(activate, memory_order_acq_rel) == activate) {
+		return;
+	}
+	// the timers and every entity stay in place, pausing and resuming them is cheap
+	for (auto &timer : {temperatureMonitorTimer, diagnosticsTimer, temperatureModelTimer, controlTimer}) {
+		if (!timer) {
+			continue;
+		}
+		if (activate) {
+			timer->reset();
+		} else {
+			timer->cancel();
+		}
+	}
+	if (activate) {
+		// an executor waiting without any running timer does not see the reset ones until woken up
+		this->get_node_base_interface()->get_notify_guard_condition().trigger();
+		RCLCPP_INFO(this->get_logger(), "Controller activated");
+		return;
+	}
+	// the deferred commands in flight complete, the goals end now
+	end_set_temperature_goals(GoalStatus::DEACTIVATED);
+	RCLCPP_INFO(this->get_logger(), "Controller deactivated");
+}
+
+bool
+TemperatureSystemsControllerNode::is_active() const {
+	return active.load(memory_order_acquire);
+}
+
+rclcpp::CallbackGroup::SharedPtr
+TemperatureSystemsControllerNode::read_callback_group() const {
+	return readCallbackGroup;
+}
+
+rclcpp::CallbackGroup::SharedPtr
+TemperatureSystemsControllerNode::telemetry_callback_group() const {
+	return telemetryCallbackGroup;
+}
+
+rclcpp::CallbackGroup::SharedPtr
+TemperatureSystemsControllerNode::actuation_callback_group() const {
+	return actuationCallbackGroup;
+}
+
+void
+TemperatureSystemsControllerNode::configure_shared_executor_thread(const string &name) const {
+	auto priority = 0;
+	vector<int64_t> cpus;
+	for (auto group : {"actuation", "telemetry", "read"}) {
+		priority = std::max(priority, (int) this->get_parameter(string(group) + "_thread_priority").as_int());
+		for (auto cpu : this->get_parameter(string(group) + "_thread_cpus").as_integer_array()) {
+			if (std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+				cpus.push_back(cpu);
+			}
+		}
+	}
+	if (priority == 0 && cpus.empty()) {
+		return;
+	}
+	string error;
+	if (!configure_realtime_thread(name, priority, cpus, error)) {
+		RCLCPP_WARN(this->get_logger(), "Thread '%s' keeps its default scheduling: %s", name.c_str(), error.c_str());
+		return;
+	}
+	RCLCPP_INFO(this->get_logger(), "Executor threads share SCHED_FIFO priority %d and %zu cores", priority,
+	            cpus.size());
+}
+
+rcl_interfaces::msg::SetParametersResult
+TemperatureSystemsControllerNode::set_parameters_callback(const vector<rclcpp::Parameter> &parameters) {
+	rcl_interfaces::msg::SetParametersResult result;
+	optional<double> telemetryRate;
+	optional<double> feedbackMaxRate;
+	optional<int64_t> feedbackMinProgress;
+	// ranges are validated against the applied bound when only the other one changes
+	auto delayMin = actuationDelayMin.load(memory_order_relaxed);
+	auto delayMax = actuationDelayMax.load(memory_order_relaxed);
+	auto delayScale = actuationDelayScale.load(memory_order_relaxed);
+	auto refusalRate = actuationRefusalRate.load(memory_order_relaxed);
+	for (auto &parameter : parameters) {
+		const auto &name = parameter.get_name();
+		if (name == "telemetry_rate_hz") {
+			telemetryRate = parameter.as_double();
+		} else if (name == "actuation_delay_min_ms") {
+			delayMin = parameter.as_int();
+		} else if (name == "actuation_delay_max_ms") {
+			delayMax = parameter.as_int();
+		} else if (name == "actuation_delay_scale") {
+			delayScale = parameter.as_double();
+		} else if (name == "actuation_refusal_rate") {
+			refusalRate = parameter.as_double();
+		} else if (name == "feedback_max_rate_hz") {
+			feedbackMaxRate = parameter.as_double();
+		} else if (name == "feedback_min_progress_step") {
+			feedbackMinProgress = parameter.as_int();
+		} else if (name != "use_sim_time") {
+			// the others size the node or name its entities, they need a restart
+			result.successful = false;
+			result.reason = "Parameter '" + name + "' is only read at startup";
+			return result;
+		}
+	}
+	if (telemetryRate && !(*telemetryRate > 0.0)) {
+		result.reason = "Telemetry rate must be positive";
+	} else if (delayMin < 0 || delayMax < delayMin) {
+		result.reason = "Actuation delays must satisfy 0 <= actuation_delay_min_ms <= actuation_delay_max_ms";
+	} else if (!(delayScale >= 0.0)) {
+		result.reason = "Actuation delay scale must not be negative";
+	} else if (!(refusalRate >= 0.0 && refusalRate <= 1.0)) {
+		result.reason = "Actuation refusal rate must be between 0 and 1";
+	} else if ((feedbackMaxRate && !(*feedbackMaxRate >= 0.0)) || (feedbackMinProgress && *feedbackMinProgress < 0)) {
+		result.reason = "Feedback throttles must not be negative";
+	}
+	if (!result.reason.empty()) {
+		result.successful = false;
+		return result;
+	}
+	
+	// the next actuation draws its delay and refusal from the new values
+	actuationDelayMin.store(delayMin, memory_order_relaxed);
+	actuationDelayMax.store(delayMax, memory_order_relaxed);
+	actuationDelayScale.store(delayScale, memory_order_relaxed);
+	actuationRefusalRate.store(refusalRate, memory_order_relaxed);
+	// the throttles are read by the steps of the goals and the monitor timer is paused by deactivation, both under
+	// the goal mutex
+	lock_guard<mutex> lock(goalMutex);
+	if (feedbackMaxRate) {
+		feedbackMinInterval = *feedbackMaxRate > 0.0 ? chrono::duration_cast<chrono::nanoseconds>(
+				chrono::duration<double>(1.0 / *feedbackMaxRate)) : chrono::nanoseconds(0);
+	}
+	if (feedbackMinProgress) {
+		feedbackMinProgressStep = (int) *feedbackMinProgress;
+	}
+	if (telemetryRate) {
+		create_temperature_monitor_timer(*telemetryRate);
+		RCLCPP_INFO(this->get_logger(), "Telemetry rate changed to %f Hz", *telemetryRate);
+	}
+	return result;
+}
+
+void
+TemperatureSystemsControllerNode::create_temperature_monitor_timer(double rate) {
+	// the previous timer may be waited on by an executor thread, cancel it before dropping it
+	if (temperatureMonitorTimer) {
+		temperatureMonitorTimer->cancel();
+	}
+	// the monitor and the actuation timers run on the node clock, following /clock with use_sim_time
+	temperatureMonitorTimer = rclcpp::create_timer(
+			this, this->get_clock(),
+			rclcpp::Duration(chrono::duration_cast<chrono::nanoseconds>(chrono::duration<double>(1.0 / rate))),
+			[this] { temperature_monitor_callback(); },
+			telemetryCallbackGroup);
+	// a rate changed while deactivated applies once the node is activated again
+	if (!active.load(memory_order_acquire)) {
+		temperatureMonitorTimer->cancel();
+	}
+}
+
+void
+TemperatureSystemsControllerNode::temperature_monitor_callback() {
+	auto now = chrono::steady_clock::now();
+	// every tick is sampled, even when the publication is skipped
+	if (temperatureHistory) {
+		auto row = temperatureHistory->append(this->now().nanoseconds());
+		for (size_t zone = 0; zone < zoneCount; zone++) {
+			row[zone] = zoneTemperatures[zone].load(memory_order_relaxed);
+		}
+	}
+	if (zoneTemperaturesPublisher) {
+		publish_zone_temperatures(now);
+	}
+	
+	short temperature = zoneTemperatures[0].load(memory_order_relaxed);
+	// skip unchanged temperatures until the heartbeat is due
+	if (!telemetry_due(abs(temperature - lastPublishedTemperature) > telemetryDeadband,
+	                   lastTemperaturePublishTime, now)) {
+		return;
+	}
+	lastPublishedTemperature = temperature;
+	RCLCPP_DEBUG(this->get_logger(), "Publishing: '%d'", temperature);
+	// publish into a buffer loaned by the middleware when it supports it, shared memory transports avoid any copy
+	if (temperaturePublisher->can_loan_messages()) {
+		auto loanedMessage = temperaturePublisher->borrow_loaned_message();
+		loanedMessage.get().data = temperature;
+		temperaturePublisher->publish(std::move(loanedMessage));
+	} else if (telemetryIntraProcess) {
+		// ownership moves to the intra process subscribers, the reused message would be copied for them
+		auto message = allocate_telemetry_message(*temperaturePublisher);
+		message->data = temperature;
+		temperaturePublisher->publish(std::move(message));
+	} else {
+		// the reused message is serialized in place
+		temperatureMessage.data = temperature;
+		temperaturePublisher->publish(temperatureMessage);
+	}
+	temperaturePublishCount.fetch_add(1, memory_order_relaxed);
+}
+
+bool
+TemperatureSystemsControllerNode::telemetry_due(bool changed,
+                                                chrono::steady_clock::time_point &lastPublishTime,
+                                                chrono::steady_clock::time_point now) {
+	if (telemetryPublishOnChange && lastPublishTime != chrono::steady_clock::time_point() && !changed &&
+	    now - lastPublishTime < telemetryMaxSilence) {
+		return false;
+	}
+	lastPublishTime = now;
+	return true;
+}
+
+void
+TemperatureSystemsControllerNode::publish_zone_temperatures(chrono::steady_clock::time_point now) {
+	// the message is reused, it holds every possible zone so it is a plain fixed size type
+	auto &temperatures = zoneTemperaturesMessage.temperatures;
+	bool changed = false;
+	for (size_t zone = 0; zone < zoneCount; zone++) {
+		temperatures[zone] = zoneTemperatures[zone].load(memory_order_relaxed);
+		changed |= abs(temperatures[zone] - lastPublishedZoneTemperatures[zone]) > telemetryDeadband;
+	}
+	// skip unchanged zones until the heartbeat is due
+	if (!telemetry_due(changed, lastZoneTemperaturesPublishTime, now)) {
+		return;
+	}
+	std::copy(temperatures.begin(), temperatures.begin() + zoneCount, lastPublishedZoneTemperatures.begin());
+	zoneTemperaturesMessage.stamp = this->now();
+	// shared memory transports loan a buffer the colocated subscribers read in place, without serialization
+	if (zoneTemperaturesPublisher->can_loan_messages()) {
+		auto loanedMessage = zoneTemperaturesPublisher->borrow_loaned_message();
+		loanedMessage.get() = zoneTemperaturesMessage;
+		zoneTemperaturesPublisher->publish(std::move(loanedMessage));
+	} else if (telemetryIntraProcess) {
+		auto message = allocate_telemetry_message(*zoneTemperaturesPublisher);
+		*message = zoneTemperaturesMessage;
+		zoneTemperaturesPublisher->publish(std::move(message));
+	} else {
+		zoneTemperaturesPublisher->publish(zoneTemperaturesMessage);
+	}
+	temperaturePublishCount.fetch_add(1, memory_order_relaxed);
+}
+
+rclcpp::QoS
+TemperatureSystemsControllerNode::telemetry_qos() {
+	rclcpp::QoS qos(std::max(1, this->declare_parameter<int>("telemetry_qos_depth", 10)));
+	// "reliable" or "best_effort"
+	auto reliability = this->declare_parameter<string>("telemetry_qos_reliability", "reliable");
+	if (reliability == "best_effort") {
+		qos.best_effort();
+	} else if (reliability != "reliable") {
+		RCLCPP_WARN(this->get_logger(), "Unknown telemetry reliability '%s', falling back to 'reliable'",
+		            reliability.c_str());
+	}
+	// "volatile" or "transient_local", late joiners get the last temperature right away with the latter
+	auto durability = this->declare_parameter<string>("telemetry_qos_durability", "volatile");
+	if (durability == "transient_local") {
+		qos.transient_local();
+	} else if (durability != "volatile") {
+		RCLCPP_WARN(this->get_logger(), "Unknown telemetry durability '%s', falling back to 'volatile'",
+		            durability.c_str());
+	}
+	return qos;
+}
+
+void
+TemperatureSystemsControllerNode::get_current_temperature_callback(
+		const std::shared_ptr<GetCurrentTemperature::Request> &request,
+		const std::shared_ptr<GetCurrentTemperature::Response> &response) {
+	auto start = chrono::steady_clock::now();
+	RCLCPP_INFO_EXPRESSION(this->get_logger(), !quietMode, "Incoming request for current temperature of zone %d",
+	                       request->zone);
+	response->success = request->zone < zoneCount;
+	response->temperature = response->success ? zoneTemperatures[request->zone].load(memory_order_relaxed) : 0;
+	readLatency.record(chrono::steady_clock::now() - start);
+}
+
+void
+TemperatureSystemsControllerNode::get_zone_temperatures_callback(
+		const std::shared_ptr<GetZoneTemperatures::Request> &request,
+		const std::shared_ptr<GetZoneTemperatures::Response> &response) {
+	auto start = chrono::steady_clock::now();
+	RCLCPP_DEBUG(this->get_logger(), "Incoming request for current temperature of %zu zones", request->zones.size());
+	// an empty request reads every zone
+	if (request->zones.empty()) {
+		response->zones.resize(zoneCount);
+		for (size_t zone = 0; zone < zoneCount; zone++) {
+			response->zones[zone] = (uint8_t) zone;
+		}
+	} else {
+		for (auto zone : request->zones) {
+			if (zone >= zoneCount) {
+				response->success = false;
+				response->message = unknownZoneMessage;
+				readLatency.record(chrono::steady_clock::now() - start);
+				return;
+			}
+		}
+		response->zones = request->zones;
+	}
+	response->temperatures.resize(response->zones.size());
+	response->stamps.resize(response->zones.size());
+	for (size_t i = 0; i < response->zones.size(); i++) {
+		auto zone = response->zones[i];
+		response->temperatures[i] = zoneTemperatures[zone].load(memory_order_relaxed);
+		response->stamps[i] = rclcpp::Time(zoneUpdateStamps[zone].load(memory_order_relaxed),
+		                                   this->get_clock()->get_clock_type());
+	}
+	response->success = true;
+	readLatency.record(chrono::steady_clock::now() - start);
+}
+
+void
+TemperatureSystemsControllerNode::get_temperature_history_callback(
+		const std::shared_ptr<GetTemperatureHistory::Request> &request,
+		const std::shared_ptr<GetTemperatureHistory::Response> &response) {
+	auto start = chrono::steady_clock::now();
+	RCLCPP_DEBUG(this->get_logger(), "Incoming request for the temperature history of zone %d", request->zone);
+	if (request->zone >= zoneCount) {
+		response->success = false;
+		readLatency.record(chrono::steady_clock::now() - start);
+		return;
+	}
+	// a window of zero or less covers the whole history
+	auto since = numeric_limits<int64_t>::min();
+	if (request->window_s > 0.0) {
+		since = this->now().nanoseconds() - chrono::duration_cast<chrono::nanoseconds>(
+				chrono::duration<double>(request->window_s)).count();
+	}
+	auto statistics = temperatureHistory->statistics(request->zone, since);
+	response->count = (uint32_t) statistics.count;
+	response->min = statistics.min;
+	response->max = statistics.max;
+	response->mean = (float) statistics.mean;
+	if (request->max_samples > 0) {
+		temperatureHistory->compact(request->zone, since, request->max_samples, historyStamps,
+		                            response->temperatures);
+		response->stamps.resize(historyStamps.size());
+		for (size_t i = 0; i < historyStamps.size(); i++) {
+			response->stamps[i] = rclcpp::Time(historyStamps[i], this->get_clock()->get_clock_type());
+		}
+	}
+	response->success = true;
+	readLatency.record(chrono::steady_clock::now() - start);
+}
+
+short
+TemperatureSystemsControllerNode::change_zone_temperature(uint8_t zone, short delta) {
+	short temperature = zoneTemperatures[zone] += delta;
+	zoneUpdateStamps[zone].store(this->now().nanoseconds(), memory_order_relaxed);
+	return temperature;
+}
+
+template<class Service>
+void
+TemperatureSystemsControllerNode::increment_decrement_temperature_callback(
+		const std::shared_ptr<typename Service::Request> &request,
+		const std::shared_ptr<typename Service::Response> &response) {
+	auto start = chrono::steady_clock::now();
+	bool isIncrement = request->increment;
+	auto delta = actuation_step(request->delta);
+	auto zone = request->zone;
+	// the sign of the delta is not a direction, a command that is not positive is refused
+	bool isValid = zone < zoneCount && request->delta > 0;
+	TEMPERATURE_CONTROL_TRACEPOINT(actuation_request, trace_id(response.get()), zone, isIncrement, delta);
+	RCLCPP_INFO_EXPRESSION(this->get_logger(), !quietMode, "Incoming request for %s temperature of zone %d by %d",
+	                       isIncrement ? "increment" : "decrement", zone, delta);
+	// a deactivated controller refuses every command
+	bool isActive = active.load(memory_order_acquire);
+	// the model moves the temperature over time, the command only moves the setpoint
+	if (temperatureModel && isValid && isActive) {
+		command_temperature_model(zone, isIncrement, delta, response);
+		TEMPERATURE_CONTROL_TRACEPOINT(actuation_response, trace_id(response.get()), response->success);
+		actuationLatency.record(chrono::steady_clock::now() - start);
+		return;
+	}
+	// check if the temperature can be increased
+	bool canIncreaseTemperature = isValid && isActive && can_actuate_temperature();
+	if (!canIncreaseTemperature) {
+		reject_increment_decrement_temperature(zone, isIncrement, request->delta, response);
+		TEMPERATURE_CONTROL_TRACEPOINT(actuation_response, trace_id(response.get()), response->success);
+		actuationLatency.record(chrono::steady_clock::now() - start);
+		return;
+	}
+	// sleep for a random time within the delay range, on the steady clock: a simulated time that does not
+	// advance would block the actuation callback group, and the teardown with it, for good
+	auto delay = actuation_delay();
+	TEMPERATURE_CONTROL_TRACEPOINT(actuation_delay, trace_id(response.get()), (int64_t) delay.count());
+	this_thread::sleep_for(delay);
+	complete_increment_decrement_temperature(zone, isIncrement, delta, response);
+	TEMPERATURE_CONTROL_TRACEPOINT(actuation_response, trace_id(response.get()), response->success);
+	actuationLatency.record(chrono::steady_clock::now() - start);
+}
+
+template<class Service>
+void
+TemperatureSystemsControllerNode::increment_decrement_temperature_deferred_callback(
+		const std::shared_ptr<rclcpp::Service<Service>> &service,
+		const std::shared_ptr<rmw_request_id_t> &requestHeader,
+		const std::shared_ptr<typename Service::Request> &request) {
+	auto start = chrono::steady_clock::now();
+	bool isIncrement = request->increment;
+	auto delta = actuation_step(request->delta);
+	auto zone = request->zone;
+	// the sign of the delta is not a direction, a command that is not positive is refused
+	bool isValid = zone < zoneCount && request->delta > 0;
+	RCLCPP_INFO_EXPRESSION(this->get_logger(), !quietMode, "Incoming request for %s temperature of zone %d by %d",
+	                       isIncrement ? "increment" : "decrement", zone, delta);
+	// the request takes a free slot and its response, the requests answered at once only use the response
+	auto &actuations = std::get<DeferredActuations<Service>>(deferredActuations);
+	DeferredActuation<Service> *slot = nullptr;
+	for (auto &candidate : actuations.slots) {
+		if (!candidate.pending) {
+			slot = &candidate;
+			break;
+		}
+	}
+	auto &response = slot ? slot->response : actuations.overflowResponse;
+	TEMPERATURE_CONTROL_TRACEPOINT(actuation_request, trace_id(response.get()), zone, isIncrement, delta);
+	// a deactivated controller refuses every command
+	bool isActive = active.load(memory_order_acquire);
+	// the model moves the temperature over time, the command only moves the setpoint
+	if (temperatureModel && isValid && isActive) {
+		command_temperature_model(zone, isIncrement, delta, response);
+		service->send_response(*requestHeader, *response);
+		TEMPERATURE_CONTROL_TRACEPOINT(actuation_response, trace_id(response.get()), response->success);
+		actuationLatency.record(chrono::steady_clock::now() - start);
+		return;
+	}
+	// check if the temperature can be increased, a request finding every slot pending is refused as well
+	if (!isValid || !isActive || !slot || !can_actuate_temperature()) {
+		reject_increment_decrement_temperature(zone, isIncrement, request->delta, response);
+		service->send_response(*requestHeader, *response);
+		TEMPERATURE_CONTROL_TRACEPOINT(actuation_response, trace_id(response.get()), response->success);
+		actuationLatency.record(chrono::steady_clock::now() - start);
+		return;
+	}
+	// respond once the actuation delay has elapsed, the executor thread is free in between
+	auto delay = actuation_delay();
+	TEMPERATURE_CONTROL_TRACEPOINT(actuation_delay, trace_id(response.get()), (int64_t) delay.count());
+	slot->pending = true;
+	slot->requestHeader = *requestHeader;
+	slot->deadline = this->now().nanoseconds() + chrono::duration_cast<chrono::nanoseconds>(delay).count();
+	slot->zone = zone;
+	slot->isIncrement = isIncrement;
+	slot->delta = delta;
+	slot->start = start;
+	// the timer is due for the earliest deadline, a later one is completed on its way
+	if (slot->deadline < actuations.timerDeadline) {
+		actuations.timerDeadline = arm_one_shot_timer(actuations.timer, delay);
+	}
+}
+
+template<class Service>
+void
+TemperatureSystemsControllerNode::create_deferred_actuations(const std::shared_ptr<rclcpp::Service<Service>> &service,
+                                                             size_t slotCount) {
+	auto &actuations = std::get<DeferredActuations<Service>>(deferredActuations);
+	actuations.service = service;
+	actuations.slots.resize(slotCount);
+	for (auto &slot : actuations.slots) {
+		slot.response = std::make_shared<typename Service::Response>();
+	}
+	actuations.overflowResponse = std::make_shared<typename Service::Response>();
+	actuations.timer = create_one_shot_timer([this] { complete_deferred_actuations<Service>(); });
+}
+
+template<class Service>
+void
+TemperatureSystemsControllerNode::complete_deferred_actuations() {
+	auto &actuations = std::get<DeferredActuations<Service>>(deferredActuations);
+	auto now = this->now().nanoseconds();
+	// dispatched before the timer was re-armed for an earlier request
+	if (now < actuations.timerDeadline) {
+		return;
+	}
+	actuations.timer->cancel();
+	actuations.timerDeadline = numeric_limits<int64_t>::max();
+	auto nextDeadline = numeric_limits<int64_t>::max();
+	for (auto &slot : actuations.slots) {
+		if (!slot.pending) {
+			continue;
+		}
+		if (slot.deadline > now) {
+			nextDeadline = std::min(nextDeadline, slot.deadline);
+			continue;
+		}
+		slot.pending = false;
+		complete_increment_decrement_temperature(slot.zone, slot.isIncrement, slot.delta, slot.response);
+		actuations.service->send_response(slot.requestHeader, *slot.response);
+		TEMPERATURE_CONTROL_TRACEPOINT(actuation_response, trace_id(slot.response.get()), slot.response->success);
+		actuationLatency.record(chrono::steady_clock::now() - slot.start);
+	}
+	if (nextDeadline != numeric_limits<int64_t>::max()) {
+		actuations.timerDeadline = arm_one_shot_timer(actuations.timer, chrono::nanoseconds(nextDeadline - now));
+	}
+}
+
+template<class Response>
+void
+TemperatureSystemsControllerNode::reject_increment_decrement_temperature(
+		uint8_t zone,
+		bool isIncrement,
+		short delta,
+		const std::shared_ptr<Response> &response) {
+	response->success = false;
+	actuationsRefused.fetch_add(1, memory_order_relaxed);
+	if (zone >= zoneCount) {
+		response->temperature = 0;
+		set_actuation_status(*response, ActuationStatus::STATUS_UNKNOWN_ZONE, unknownZoneMessage);
+		return;
+	}
+	response->temperature = zoneTemperatures[zone].load(memory_order_relaxed);
+	if (delta <= 0) {
+		set_actuation_status(*response, ActuationStatus::STATUS_INVALID_DELTA, invalidDeltaMessage);
+		return;
+	}
+	set_actuation_status(*response, ActuationStatus::STATUS_REFUSED, refusedMessages[isIncrement]);
+}
+
+template<class Response>
+void
+TemperatureSystemsControllerNode::complete_increment_decrement_temperature(
+		uint8_t zone,
+		bool isIncrement,
+		short delta,
+		const std::shared_ptr<Response> &response) {
+	// increase/decrease the temperature
+	response->temperature = change_zone_temperature(zone, isIncrement ? delta : (short) -delta);
+	response->success = true;
+	actuationsCompleted.fetch_add(1, memory_order_relaxed);
+	// the success flag says it all in quiet mode, filling the message would allocate
+	set_actuation_status(*response, ActuationStatus::STATUS_ACTUATED,
+	                     quietMode ? nullptr : actuatedMessages[isIncrement]);
+	RCLCPP_INFO_EXPRESSION(this->get_logger(), !quietMode, "%s", actuatedMessages[isIncrement]);
+}
+
+template<class Response>
+void
+TemperatureSystemsControllerNode::command_temperature_model(
+		uint8_t zone,
+		bool isIncrement,
+		short delta,
+		const std::shared_ptr<Response> &response) {
+	auto temperature = zoneTemperatures[zone].load(memory_order_relaxed);
+	zoneSetpoints[zone] = temperature + (isIncrement ? delta : -delta);
+	response->temperature = temperature;
+	response->success = true;
+	actuationsCompleted.fetch_add(1, memory_order_relaxed);
+	set_actuation_status(*response, ActuationStatus::STATUS_COMMANDED,
+	                     quietMode ? nullptr : commandedMessages[isIncrement]);
+}
+
+short
+TemperatureSystemsControllerNode::actuation_step(int delta) const {
+	// a goal always steps at least one degree, requests that are not positive are refused before
+	return (short) std::min<int>(std::max(delta, 1), maxActuationStep);
+}
+
+bool
+TemperatureSystemsControllerNode::can_actuate_temperature() {
+	// the draws are uniform on 32 bits, the refusal rate is the share of them below the threshold
+	auto threshold = (uint64_t) (actuationRefusalRate.load(memory_order_relaxed) * 4294967296.0);
+	return (uint64_t) randomNumber() >= threshold;
+}
+
+chrono::milliseconds
+TemperatureSystemsControllerNode::actuation_delay() {
+	// random time within the delay range, 0.1s to 0.5s by default, scaled for simulations
+	auto delayMin = actuationDelayMin.load(memory_order_relaxed);
+	auto delayMax = actuationDelayMax.load(memory_order_relaxed);
+	auto delay = chrono::milliseconds(delayMin);
+	if (delayMax > delayMin) {
+		delay += chrono::milliseconds(randomNumber() % (uint64_t) (delayMax - delayMin));
+	}
+	return chrono::duration_cast<chrono::milliseconds>(delay * actuationDelayScale.load(memory_order_relaxed));
+}
+
+chrono::milliseconds
+TemperatureSystemsControllerNode::actuation_retry_delay() const {
+	// a refusal rate of 1 would otherwise retry on every spin without ever giving the executor a rest
+	auto delay = chrono::duration_cast<chrono::milliseconds>(
+			chrono::milliseconds(actuationDelayMin.load(memory_order_relaxed)) *
+			actuationDelayScale.load(memory_order_relaxed));
+	return std::max(delay, chrono::milliseconds(1));
+}
+
+template<class Action>
+rclcpp_action::GoalResponse
+TemperatureSystemsControllerNode::handle_set_temperature_action_callback(
+		const rclcpp_action::GoalUUID &uuid,
+		const shared_ptr<const typename Action::Goal> &goal) {
+	RCLCPP_INFO(this->get_logger(), "Incoming request for setting temperature of zone %d", goal->zone);
+	if (goal->zone >= zoneCount || !valid_goal(*goal) || !active.load(memory_order_acquire)) {
+		goalsRejected.fetch_add(1, memory_order_relaxed);
+		TEMPERATURE_CONTROL_TRACEPOINT(goal_handled, goal->zone, 0);
+		return rclcpp_action::GoalResponse::REJECT;
+	}
+	// queued and preempting goals are always admitted, they are arranged once accepted
+	// only the goal that flips the flag of its zone is admitted otherwise
+	bool expectedBusy = false;
+	if (goalPolicy == GoalPolicy::REJECT &&
+	    !zoneBusy[goal->zone].compare_exchange_strong(expectedBusy, true, memory_order_acq_rel)) {
+		goalsRejected.fetch_add(1, memory_order_relaxed);
+		TEMPERATURE_CONTROL_TRACEPOINT(goal_handled, goal->zone, 0);
+		return rclcpp_action::GoalResponse::REJECT;
+	}
+	goalsAccepted.fetch_add(1, memory_order_relaxed);
+	TEMPERATURE_CONTROL_TRACEPOINT(goal_handled, goal->zone, 1);
+	return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+}
+
+template<class Action>
+rclcpp_action::CancelResponse
+TemperatureSystemsControllerNode::cancel_set_temperature_action_callback(
+		const shared_ptr<rclcpp_action::ServerGoalHandle<Action>> &goalHandle) {
+	RCLCPP_INFO(this->get_logger(), "Incoming request for cancelling setting temperature");
+	return rclcpp_action::CancelResponse::ACCEPT;
+}
+
+void
+TemperatureSystemsControllerNode::accepted_set_temperature_action_callback(
+		const shared_ptr<TemperatureGoal> &goal) {
+	RCLCPP_INFO(this->get_logger(), "Incoming request for accepting setting temperature");
+	auto zone = goal->zone();
+	TEMPERATURE_CONTROL_TRACEPOINT(goal_accepted, trace_id(goal.get()), zone, goal->target_temperature());
+	auto &goals = zoneGoals[zone];
+	{
+		lock_guard<mutex> lock(goalMutex);
+		// the node was deactivated between admitting and accepting the goal
+		if (!active.load(memory_order_acquire)) {
+			finish_set_temperature_goal(zone, goal, GoalStatus::DEACTIVATED,
+			                            zoneTemperatures[zone].load(memory_order_relaxed));
+			if (!goals.goal) {
+				zoneBusy[zone].store(false, memory_order_release);
+			}
+			return;
+		}
+		if (goals.goal) {
+			if (goalPolicy == GoalPolicy::QUEUE) {
+				goals.queuedGoals.push_back(goal);
+				return;
+			}
+			// the running stepper or loopback carries on towards the new target
+			complete_active_set_temperature_goal(zone, GoalStatus::PREEMPTED,
+			                                     zoneTemperatures[zone].load(memory_order_relaxed));
+			activate_set_temperature_goal(zone, goal);
+			return;
+		}
+		zoneBusy[zone].store(true, memory_order_release);
+		goals.actuating = false;
+		activate_set_temperature_goal(zone, goal);
+		// the loopback runs on the responses of the service, starting with the first request
+		if (actionLoopback) {
+			loopback_set_temperature_step(zone);
+			return;
+		}
+		// the model update tracks the goal from now on
+		if (temperatureModel) {
 			return;
 		}
-		// sleep for a random time between 0.1s and 0.5s
-		
-		auto sleepTime = 100 + (randomNumber() % 400);
-		this_thread::sleep_for(chrono::milliseconds(sleepTime));
-		// increase/decrease the temperature
-		currentTemperature += isIncrement ? 1 : -1;
-		response->success = true;
-		response->temperature = currentTemperature;
-		response->message = "Temperature " + string(isIncrement ? "increased" : "decreased") + " successfully";
-		RCLCPP_INFO(this->get_logger(), "%s", response->message.c_str());
-	}
-
-private:
-	rclcpp_action::GoalResponse
-	handle_set_temperature_action_callback(const rclcpp_action::GoalUUID &uuid,
-	                                       const shared_ptr<const SetTemperature::Goal> &goal) {
-		RCLCPP_INFO(this->get_logger(), "Incoming request for setting temperature");
-		if (actionServerBusy) {
-			return rclcpp_action::GoalResponse::REJECT;
-		}
-		actionServerBusy = true;
-		return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
-	}
-
-private:
-	rclcpp_action::CancelResponse
-	cancel_set_temperature_action_callback(
-			const shared_ptr<rclcpp_action::ServerGoalHandle<SetTemperature>> &goalHandle) {
-		RCLCPP_INFO(this->get_logger(), "Incoming request for cancelling setting temperature");
-		return rclcpp_action::CancelResponse::ACCEPT;
-	}
-
-private:
-	void
-	accepted_set_temperature_action_callback(
-			const shared_ptr<rclcpp_action::ServerGoalHandle<SetTemperature>> &goalHandle) {
-		actionThread = thread([this, goalHandle]() {
-			RCLCPP_INFO(this->get_logger(), "Incoming request for accepting setting temperature");
-			auto feedback = std::make_shared<SetTemperature::Feedback>();
-			auto result = std::make_shared<SetTemperature::Result>();
-			auto goal = goalHandle->get_goal();
-			auto targetTemperature = goal->temperature;
-			auto initialTemperature = currentTemperature;
-			auto temperature = currentTemperature;
-			auto is_increment = targetTemperature > currentTemperature;
-			
-			while (temperature != targetTemperature) {
-				// check if there is a cancel request
-				if (goalHandle->is_canceling()) {
-					result->success = false;
-					result->temperature = temperature;
-					result->message = "Setting temperature cancelled";
-					goalHandle->canceled(result);
-					actionServerBusy = false;
-					RCLCPP_INFO(this->get_logger(), "Setting temperature cancelled");
+		// armed under the lock, a deactivation either comes first and ends the goal above or cancels this step
+		schedule_set_temperature_step(zone, 0ms);
+	}
+}
+
+void
+TemperatureSystemsControllerNode::loopback_set_temperature_step(uint8_t zone) {
+	auto &goals = zoneGoals[zone];
+	short temperature = zoneTemperatures[zone].load(memory_order_relaxed);
+	// end the goals that are over, moving on to the queued ones
+	while (goals.goal) {
+		// check if there is a cancel request
+		if (goals.goal->is_canceling()) {
+			finish_active_set_temperature_goal(zone, GoalStatus::CANCELLED, temperature);
+			continue;
+		}
+		// a reached target is held, then the goal moves on to its next target or succeeds
+		if (goals.holding || temperature == zoneTargetTemperatures[zone].load(memory_order_relaxed)) {
+			if (set_temperature_target_reached(zone)) {
+				finish_active_set_temperature_goal(zone, GoalStatus::SUCCEEDED, temperature);
+				continue;
+			}
+			if (goals.holding) {
+				arm_loopback_timer(zone, set_temperature_hold_remaining(zone), ++goals.loopbackSequence, false);
+				return;
+			}
+			continue;
+		}
+		if (incrementDecrementTemperatureClient->service_is_ready()) {
+			goals.loopbackServiceWaitStart = {};
+			break;
+		}
+		// poll the service until the timeout, the executor carries on in between
+		auto now = chrono::steady_clock::now();
+		if (goals.loopbackServiceWaitStart == chrono::steady_clock::time_point()) {
+			goals.loopbackServiceWaitStart = now;
+		}
+		if (now - goals.loopbackServiceWaitStart < loopbackServiceTimeout) {
+			arm_loopback_timer(zone, chrono::milliseconds(100), ++goals.loopbackSequence, false);
+			return;
+		}
+		goals.loopbackServiceWaitStart = {};
+		finish_active_set_temperature_goal(zone, GoalStatus::SERVICE_UNAVAILABLE, temperature);
+	}
+	if (!goals.goal) {
+		return;
+	}
+	
+	// call the increment/decrement service, the response or the timeout runs the next step
+	if (!goals.loopbackRequest) {
+		goals.loopbackRequest = std::make_shared<IncrementDecrementTemperature::Request>();
+		goals.loopbackRequest->zone = zone;
+	}
+	auto step = set_temperature_step(zone, temperature);
+	goals.loopbackRequest->increment = step > 0;
+	goals.loopbackRequest->delta = (short) abs(step);
+	auto sequence = ++goals.loopbackSequence;
+	auto stepStartTime = chrono::steady_clock::now();
+	TEMPERATURE_CONTROL_TRACEPOINT(loopback_request, zone, sequence);
+	goals.loopbackRequestId = incrementDecrementTemperatureClient->async_send_request(
+			goals.loopbackRequest,
+			[this, zone, sequence, stepStartTime](rclcpp::Client<IncrementDecrementTemperature>::SharedFuture future) {
+				lock_guard<mutex> lock(goalMutex);
+				auto &goals = zoneGoals[zone];
+				// the request timed out and was given up already
+				if (sequence != goals.loopbackSequence) {
 					return;
 				}
-				
-				// call the increment/decrement service
-				auto request = std::make_shared<IncrementDecrementTemperature::Request>();
-				request->increment = is_increment;
-				// create a client for the service
-				auto incrementDecrementTemperatureClient = this->create_client<IncrementDecrementTemperature>(
-						contextPrefix + "__increment_decrement_temperature");
-				// send the request
-				auto future = incrementDecrementTemperatureClient->async_send_request(request);
-				// wait for the response indefinitely
-				auto response = future.get();
+				TEMPERATURE_CONTROL_TRACEPOINT(loopback_response, zone, sequence);
+				goals.loopbackTimer->cancel();
+				goals.loopbackDeadline = numeric_limits<int64_t>::max();
+				stepLatency.record(chrono::steady_clock::now() - stepStartTime);
 				// publish the feedback
-				temperature = response->temperature;
-				feedback->temperature = temperature;
-				feedback->progress = (temperature - initialTemperature) * 100 /
-				                     (targetTemperature - initialTemperature);
-				goalHandle->publish_feedback(feedback);
-				RCLCPP_DEBUG(this->get_logger(), "Publishing feedback: '%s'", to_string(feedback->progress).c_str());
+				auto response = future.get();
+				if (goals.goal) {
+					publish_set_temperature_feedback(zone, response->temperature);
+				}
+				// a refused command is sent again after the backoff, as the stepper does
+				if (goals.goal && !response->success) {
+					arm_loopback_timer(zone, actuation_retry_delay(), ++goals.loopbackSequence, false);
+					return;
+				}
+				loopback_set_temperature_step(zone);
+			}).request_id;
+	arm_loopback_timer(zone, loopbackServiceTimeout, sequence, true);
+}
+
+void
+TemperatureSystemsControllerNode::arm_loopback_timer(uint8_t zone, chrono::nanoseconds delay, uint64_t sequence,
+                                                     bool timedOut) {
+	auto &goals = zoneGoals[zone];
+	goals.loopbackTimerSequence = sequence;
+	goals.loopbackTimerTimedOut = timedOut;
+	goals.loopbackDeadline = arm_one_shot_timer(goals.loopbackTimer, delay);
+}
+
+void
+TemperatureSystemsControllerNode::loopback_set_temperature_timer_callback(uint8_t zone) {
+	lock_guard<mutex> lock(goalMutex);
+	auto &goals = zoneGoals[zone];
+	// dispatched before the timer was re-armed or after the response disarmed it
+	if (this->now().nanoseconds() < goals.loopbackDeadline) {
+		return;
+	}
+	// the response arrived first, the timer may already be armed for the next request
+	if (goals.loopbackTimerSequence != goals.loopbackSequence) {
+		return;
+	}
+	// one shot timer, cancelled as soon as it runs, only once it is known to be the current one
+	goals.loopbackTimer->cancel();
+	goals.loopbackDeadline = numeric_limits<int64_t>::max();
+	// give up on the request, a late response is ignored
+	if (goals.loopbackTimerTimedOut) {
+		goals.loopbackSequence++;
+		incrementDecrementTemperatureClient->remove_pending_request(goals.loopbackRequestId);
+		if (goals.goal) {
+			finish_active_set_temperature_goal(zone, GoalStatus::SERVICE_TIMED_OUT,
+			                                   zoneTemperatures[zone].load(memory_order_relaxed));
+		}
+	}
+	loopback_set_temperature_step(zone);
+}
+
+void
+TemperatureSystemsControllerNode::activate_set_temperature_goal(
+		uint8_t zone, const shared_ptr<TemperatureGoal> &goal) {
+	auto &goals = zoneGoals[zone];
+	goals.goal = goal;
+	goals.stepSize = actuation_step(goal->step_size());
+	start_set_temperature_target(zone);
+}
+
+void
+TemperatureSystemsControllerNode::start_set_temperature_target(uint8_t zone) {
+	auto &goals = zoneGoals[zone];
+	auto target = goals.goal->target_temperature();
+	goals.initialTemperature = zoneTemperatures[zone].load(memory_order_relaxed);
+	zoneTargetTemperatures[zone].store(target, memory_order_relaxed);
+	if (temperatureModel) {
+		zoneSetpoints[zone] = target;
+	}
+	goals.holding = false;
+	goals.lastFeedbackProgress = -1;
+}
+
+bool
+TemperatureSystemsControllerNode::set_temperature_target_reached(uint8_t zone) {
+	auto &goals = zoneGoals[zone];
+	auto now = this->now().nanoseconds();
+	if (!goals.holding) {
+		goals.holding = true;
+		goals.holdEnd = now + chrono::duration_cast<chrono::nanoseconds>(
+				chrono::duration<double>(std::max(0.0, goals.goal->hold_time()))).count();
+	}
+	if (now < goals.holdEnd) {
+		return false;
+	}
+	if (!goals.goal->next_target()) {
+		return true;
+	}
+	// the next segment starts right away from the temperature reached
+	start_set_temperature_target(zone);
+	return false;
+}
+
+chrono::milliseconds
+TemperatureSystemsControllerNode::set_temperature_hold_remaining(uint8_t zone) const {
+	auto &goals = zoneGoals[zone];
+	if (!goals.holding) {
+		return 0ms;
+	}
+	// rounded up, waking before the end of the hold would only schedule another wait
+	auto remaining = chrono::nanoseconds(std::max<int64_t>(goals.holdEnd - this->now().nanoseconds(), 0));
+	// long holds wake up regularly so a cancel request is not left waiting
+	return std::min(chrono::ceil<chrono::milliseconds>(remaining), chrono::milliseconds(100));
+}
+
+void
+TemperatureSystemsControllerNode::finish_set_temperature_goal(
+		uint8_t zone, const shared_ptr<TemperatureGoal> &goal, GoalStatus status, short temperature) {
+	TEMPERATURE_CONTROL_TRACEPOINT(goal_finished, trace_id(goal.get()), zone, (uint8_t) status);
+	goal->finish(status, temperature, goalStatusMessages[(size_t) status]);
+	goalOutcomes[(size_t) goal_outcome(status)].fetch_add(1, memory_order_relaxed);
+}
+
+void
+TemperatureSystemsControllerNode::complete_active_set_temperature_goal(
+		uint8_t zone, GoalStatus status, short temperature) {
+	auto &goal = zoneGoals[zone].goal;
+	finish_set_temperature_goal(zone, goal, status, temperature);
+	goal.reset();
+	RCLCPP_INFO(this->get_logger(), "Zone %d: %s", zone, goalStatusMessages[(size_t) status]);
+}
+
+void
+TemperatureSystemsControllerNode::end_set_temperature_goals(GoalStatus status) {
+	for (size_t zone = 0; zone < zoneCount; zone++) {
+		auto &goals = zoneGoals[zone];
+		for (auto &timer : {goals.stepperTimer, goals.loopbackTimer}) {
+			if (timer) {
+				timer->cancel();
 			}
-			
-			result->success = true;
-			result->temperature = temperature;
-			result->message = "Setting temperature succeeded";
-			goalHandle->succeed(result);
-			actionServerBusy = false;
-			RCLCPP_INFO(this->get_logger(), "Setting temperature succeeded");
-		});
-		
-		actionThread.detach();
+		}
+		goals.stepperDeadline = numeric_limits<int64_t>::max();
+		goals.loopbackDeadline = numeric_limits<int64_t>::max();
+		// the step being actuated and the loopback response in flight are dropped
+		goals.loopbackSequence++;
+		goals.actuating = false;
+		goals.holding = false;
+		auto temperature = zoneTemperatures[zone].load(memory_order_relaxed);
+		for (auto &goal : goals.queuedGoals) {
+			finish_set_temperature_goal((uint8_t) zone, goal, status, temperature);
+		}
+		goals.queuedGoals.clear();
+		if (goals.goal) {
+			complete_active_set_temperature_goal((uint8_t) zone, status, temperature);
+		}
+		zoneBusy[zone].store(false, memory_order_release);
 	}
-	
-};
+}
+
+bool
+TemperatureSystemsControllerNode::finish_active_set_temperature_goal(
+		uint8_t zone, GoalStatus status, short temperature) {
+	complete_active_set_temperature_goal(zone, status, temperature);
+	auto &queuedGoals = zoneGoals[zone].queuedGoals;
+	while (!queuedGoals.empty()) {
+		auto goal = queuedGoals.front();
+		queuedGoals.pop_front();
+		// goals cancelled while queued end without running
+		if (goal->is_canceling()) {
+			finish_set_temperature_goal(zone, goal, GoalStatus::CANCELLED, temperature);
+			continue;
+		}
+		activate_set_temperature_goal(zone, goal);
+		return true;
+	}
+	zoneBusy[zone].store(false, memory_order_release);
+	return false;
+}
+
+short
+TemperatureSystemsControllerNode::set_temperature_step(uint8_t zone, short temperature) const {
+	// never step past the target
+	auto remaining = zoneTargetTemperatures[zone].load(memory_order_relaxed) - temperature;
+	auto step = std::min<int>(abs(remaining), zoneGoals[zone].stepSize);
+	return (short) (remaining > 0 ? step : -step);
+}
 
 int
-main(int argc, char *argv[]) {
-	rclcpp::init(argc, argv);
-	rclcpp::spin(std::make_shared<TemperatureSystemsControllerNode>());
-	rclcpp::shutdown();
-	return 0;
-}
\ No newline at end of file
+TemperatureSystemsControllerNode::set_temperature_progress(uint8_t zone, short temperature) const {
+	auto initialTemperature = zoneGoals[zone].initialTemperature;
+	int distance = zoneTargetTemperatures[zone].load(memory_order_relaxed) - initialTemperature;
+	// a preempting goal may target the temperature it started from
+	if (distance == 0) {
+		return 100;
+	}
+	int progress = (temperature - initialTemperature) * 100 / distance;
+	// overshooting or moving away while retargeted stays within the range
+	return std::min(std::max(progress, 0), 100);
+}
+
+void
+TemperatureSystemsControllerNode::publish_set_temperature_feedback(uint8_t zone, short temperature) {
+	auto &goals = zoneGoals[zone];
+	int progress = set_temperature_progress(zone, temperature);
+	auto now = chrono::steady_clock::now();
+	// throttle on both the progress made and the time elapsed since the last feedback
+	if (goals.lastFeedbackProgress >= 0) {
+		if (feedbackMinProgressStep > 0 && progress != 100 &&
+		    abs(progress - goals.lastFeedbackProgress) < feedbackMinProgressStep) {
+			return;
+		}
+		if (now - goals.lastFeedbackTime < feedbackMinInterval) {
+			return;
+		}
+	}
+	goals.lastFeedbackProgress = progress;
+	goals.lastFeedbackTime = now;
+	auto timeRemaining = set_temperature_time_remaining(zone, temperature);
+	TEMPERATURE_CONTROL_TRACEPOINT(feedback_publish_begin, zone, (int16_t) progress);
+	goals.goal->publish_feedback(temperature, (short) progress, isinf(timeRemaining) ? -1.0f : (float) timeRemaining);
+	TEMPERATURE_CONTROL_TRACEPOINT(feedback_publish_end, zone);
+	feedbackPublishCount.fetch_add(1, memory_order_relaxed);
+	RCLCPP_DEBUG(this->get_logger(), "Publishing feedback of zone %d: '%d'", zone, progress);
+}
+
+double
+TemperatureSystemsControllerNode::set_temperature_time_remaining(uint8_t zone, short temperature) const {
+	auto target = zoneTargetTemperatures[zone].load(memory_order_relaxed);
+	if (temperatureModel) {
+		return temperatureModel->time_to_target(zoneModelTemperatures[zone], target);
+	}
+	// every step waits the mean of the delay range once accepted, and the retry delay for each refusal before
+	auto steps = (abs(target - temperature) + zoneGoals[zone].stepSize - 1) / zoneGoals[zone].stepSize;
+	if (steps == 0) {
+		return 0.0;
+	}
+	auto refusalRate = actuationRefusalRate.load(memory_order_relaxed);
+	if (refusalRate >= 1.0) {
+		return numeric_limits<double>::infinity();
+	}
+	auto meanDelay = (double) (actuationDelayMin.load(memory_order_relaxed) +
+	                           actuationDelayMax.load(memory_order_relaxed)) / 2000.0;
+	// commands are refused independently, a step is refused rate / (1 - rate) times on average
+	auto meanRefusals = refusalRate / (1.0 - refusalRate);
+	auto retryDelay = chrono::duration<double>(actuation_retry_delay()).count();
+	return steps * (meanDelay * actuationDelayScale.load(memory_order_relaxed) + meanRefusals * retryDelay);
+}
+
+template<class Callback>
+rclcpp::TimerBase::SharedPtr
+TemperatureSystemsControllerNode::create_one_shot_timer(Callback &&callback) {
+	// the period is replaced by every arming, the timer stays cancelled until then
+	auto timer = rclcpp::create_timer(this, this->get_clock(), rclcpp::Duration(1s), std::forward<Callback>(callback),
+	                                  actuationCallbackGroup);
+	timer->cancel();
+	return timer;
+}
+
+int64_t
+TemperatureSystemsControllerNode::arm_one_shot_timer(const rclcpp::TimerBase::SharedPtr &timer,
+                                                     chrono::nanoseconds delay) {
+	auto deadline = this->now().nanoseconds() + delay.count();
+	// the period is the delay until the next call once the timer is reset, its callback cancels it
+	int64_t previousPeriod;
+	auto ret = rcl_timer_exchange_period(timer->get_timer_handle().get(), delay.count(), &previousPeriod);
+	if (ret != RCL_RET_OK) {
+		rclcpp::exceptions::throw_from_rcl_error(ret, "Couldn't arm the timer");
+	}
+	timer->reset();
+	// an executor thread waiting while the timer was cancelled does not see it until woken up
+	this->get_node_base_interface()->get_notify_guard_condition().trigger();
+	return deadline;
+}
+
+void
+TemperatureSystemsControllerNode::schedule_set_temperature_step(uint8_t zone, chrono::milliseconds delay) {
+	TEMPERATURE_CONTROL_TRACEPOINT(step_scheduled, zone, (int64_t) delay.count());
+	auto &goals = zoneGoals[zone];
+	goals.stepperDeadline = arm_one_shot_timer(goals.stepperTimer, delay);
+}
+
+void
+TemperatureSystemsControllerNode::set_temperature_stepper_callback(uint8_t zone) {
+	auto &goals = zoneGoals[zone];
+	lock_guard<mutex> lock(goalMutex);
+	// dispatched before the timer was re-armed for a later step
+	if (this->now().nanoseconds() < goals.stepperDeadline) {
+		return;
+	}
+	TEMPERATURE_CONTROL_TRACEPOINT(step_started, zone);
+	// one shot timer, cancelled as soon as the step runs
+	goals.stepperTimer->cancel();
+	goals.stepperDeadline = numeric_limits<int64_t>::max();
+	// the goal was ended by a deactivation while this step was being dispatched
+	if (!goals.goal) {
+		return;
+	}
+	
+	short temperature = zoneTemperatures[zone].load(memory_order_relaxed);
+	
+	// the actuation delay of the pending step has elapsed, apply it to the temperature
+	if (goals.actuating) {
+		goals.actuating = false;
+		temperature = change_zone_temperature(zone, goals.actuationDelta);
+		TEMPERATURE_CONTROL_TRACEPOINT(actuation_applied, zone, temperature);
+		stepLatency.record(chrono::steady_clock::now() - goals.stepStartTime);
+		publish_set_temperature_feedback(zone, temperature);
+	}
+	
+	// check if there is a cancel request
+	if (goals.goal->is_canceling()) {
+		if (finish_active_set_temperature_goal(zone, GoalStatus::CANCELLED, temperature)) {
+			schedule_set_temperature_step(zone, 0ms);
+		}
+		return;
+	}
+	
+	// a reached target is held, then the goal moves on to its next target or succeeds
+	if (goals.holding || temperature == zoneTargetTemperatures[zone].load(memory_order_relaxed)) {
+		if (set_temperature_target_reached(zone)) {
+			if (finish_active_set_temperature_goal(zone, GoalStatus::SUCCEEDED, temperature)) {
+				schedule_set_temperature_step(zone, 0ms);
+			}
+			return;
+		}
+		schedule_set_temperature_step(zone, set_temperature_hold_remaining(zone));
+		return;
+	}
+	
+	// start the next step, a rejected command is retried after a backoff
+	goals.actuationDelta = set_temperature_step(zone, temperature);
+	if (!can_actuate_temperature()) {
+		schedule_set_temperature_step(zone, actuation_retry_delay());
+		return;
+	}
+	goals.actuating = true;
+	goals.stepStartTime = chrono::steady_clock::now();
+	TEMPERATURE_CONTROL_TRACEPOINT(actuation_commanded, zone, goals.actuationDelta);
+	schedule_set_temperature_step(zone, actuation_delay());
+}
+
+void
+TemperatureSystemsControllerNode::temperature_model_update_callback() {
+	lock_guard<mutex> lock(goalMutex);
+	auto stamp = this->now().nanoseconds();
+	for (size_t zone = 0; zone < zoneCount; zone++) {
+		if (!pidControl) {
+			command_actuator_power((uint8_t) zone, temperature_model_power((uint8_t) zone));
+		}
+		auto &modelTemperature = zoneModelTemperatures[zone];
+		modelTemperature = temperatureModel->step(modelTemperature, zonePowers[zone], temperatureModelTimeStep);
+		// readers only see whole degrees, updated when they change
+		auto temperature = (short) lround(modelTemperature);
+		bool changed = temperature != zoneTemperatures[zone].load(memory_order_relaxed);
+		if (changed) {
+			zoneTemperatures[zone].store(temperature, memory_order_relaxed);
+			zoneUpdateStamps[zone].store(stamp, memory_order_relaxed);
+		}
+		update_temperature_model_goal((uint8_t) zone, temperature, changed);
+	}
+}
+
+void
+TemperatureSystemsControllerNode::control_callback() {
+	for (size_t zone = 0; zone < zoneCount; zone++) {
+		command_actuator_power((uint8_t) zone, temperature_model_power((uint8_t) zone));
+	}
+}
+
+double
+TemperatureSystemsControllerNode::temperature_model_power(uint8_t zone) {
+	auto setpoint = zoneSetpoints[zone];
+	if (isnan(setpoint)) {
+		// the next command starts the controller afresh
+		if (pidControl) {
+			zonePidControllers[zone].reset();
+		}
+		return 0.0;
+	}
+	auto temperature = zoneModelTemperatures[zone];
+	auto driftRate = temperatureModel->rate(temperature, 0.0);
+	auto authority = temperatureModel->rate(temperature, 1.0) - driftRate;
+	if (authority <= 0.0) {
+		return 0.0;
+	}
+	// the feed forward cancels the drift of the zone, the controller only has to correct the error
+	auto feedForward = -driftRate / authority;
+	if (pidControl) {
+		return zonePidControllers[zone].update(setpoint, temperature, controlTimeStep, feedForward);
+	}
+	// approach the setpoint at a rate proportional to the error
+	auto power = modelControlGain * (setpoint - temperature) / authority + feedForward;
+	return std::min(std::max(power, -1.0), 1.0);
+}
+
+void
+TemperatureSystemsControllerNode::command_actuator_power(uint8_t zone, double power) {
+	auto &currentPower = zonePowers[zone];
+	// switching off is always sent, small corrections are not worth a command
+	if (power == currentPower || (power != 0.0 && abs(power - currentPower) <= controlOutputDeadband)) {
+		return;
+	}
+	currentPower = power;
+	actuatorCommands.fetch_add(1, memory_order_relaxed);
+}
+
+void
+TemperatureSystemsControllerNode::update_temperature_model_goal(uint8_t zone, short temperature, bool changed) {
+	auto &goals = zoneGoals[zone];
+	if (!goals.goal) {
+		return;
+	}
+	if (changed) {
+		publish_set_temperature_feedback(zone, temperature);
+	}
+	
+	// a cancelled goal holds the temperature it reached
+	if (goals.goal->is_canceling()) {
+		zoneSetpoints[zone] = zoneModelTemperatures[zone];
+		finish_active_set_temperature_goal(zone, GoalStatus::CANCELLED, temperature);
+		return;
+	}
+	
+	// the setpoint stays on the target, holding it while the goal waits and once it succeeded
+	if ((goals.holding || temperature == zoneTargetTemperatures[zone].load(memory_order_relaxed)) &&
+	    set_temperature_target_reached(zone)) {
+		finish_active_set_temperature_goal(zone, GoalStatus::SUCCEEDED, temperature);
+	}
+}
+
+void
+TemperatureSystemsControllerNode::publish_diagnostics() {
+	auto message = std::make_unique<diagnostic_msgs::msg::DiagnosticArray>();
+	message->header.stamp = this->now();
+	message->status.resize(1);
+	auto &status = message->status[0];
+	status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+	status.name = string(this->get_name()) + ": actuator";
+	status.hardware_id = contextPrefix;
+	status.message = "Running";
+	auto addValue = [&status](const string &key, const string &value) {
+		diagnostic_msgs::msg::KeyValue keyValue;
+		keyValue.key = key;
+		keyValue.value = value;
+		status.values.push_back(std::move(keyValue));
+	};
+	// latencies in microseconds, percentiles are bucket bounds within 12.5%
+	auto addLatency = [&addValue](const string &name, const LatencyHistogram &histogram) {
+		addValue(name + " count", to_string(histogram.samples()));
+		addValue(name + " mean us", to_string(histogram.mean_us()));
+		addValue(name + " p50 us", to_string(histogram.percentile_us(0.50)));
+		addValue(name + " p99 us", to_string(histogram.percentile_us(0.99)));
+		addValue(name + " max us", to_string(histogram.max_us()));
+	};
+	addLatency("read service", readLatency);
+	addLatency("actuation service", actuationLatency);
+	addLatency("action step", stepLatency);
+	addValue("actuations completed", to_string(actuationsCompleted.load(memory_order_relaxed)));
+	addValue("actuations refused", to_string(actuationsRefused.load(memory_order_relaxed)));
+	addValue("goals accepted", to_string(goalsAccepted.load(memory_order_relaxed)));
+	addValue("goals rejected", to_string(goalsRejected.load(memory_order_relaxed)));
+	addValue("goals succeeded", to_string(goalOutcomes[(size_t) GoalOutcome::SUCCEEDED].load(memory_order_relaxed)));
+	addValue("goals canceled", to_string(goalOutcomes[(size_t) GoalOutcome::CANCELED].load(memory_order_relaxed)));
+	addValue("goals aborted", to_string(goalOutcomes[(size_t) GoalOutcome::ABORTED].load(memory_order_relaxed)));
+	addValue("actuator commands", to_string(actuatorCommands.load(memory_order_relaxed)));
+	addValue("temperature publishes", to_string(temperaturePublishCount.load(memory_order_relaxed)));
+	addValue("feedback publishes", to_string(feedbackPublishCount.load(memory_order_relaxed)));
+	diagnosticsPublisher->publish(std::move(message));
+}
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+RCLCPP_COMPONENTS_REGISTER_NODE(TemperatureSystemsControllerNode)
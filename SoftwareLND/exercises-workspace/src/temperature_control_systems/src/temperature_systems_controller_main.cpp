@@ -0,0 +1,106 @@
+#include "temperature_control_systems/realtime.hpp"
+#include "temperature_control_systems/temperature_systems_controller.hpp"
+
+#include <thread>
+
+using namespace std;
+
+// spins every callback group on its own single threaded executor, with its own priority and cores
+// the default callback group, holding the parameter services, spins on the calling thread
+static void
+spin_callback_group_threads(const shared_ptr<TemperatureSystemsControllerNode> &node, bool lockMemory,
+                            size_t stackPrefaultSize) {
+	struct GroupThread {
+		const char *name;
+		rclcpp::CallbackGroup::SharedPtr callbackGroup;
+		int priority;
+		vector<int64_t> cpus;
+	};
+	vector<GroupThread> groupThreads = {
+			{"actuation", node->actuation_callback_group(),
+					(int) node->get_parameter("actuation_thread_priority").as_int(),
+					node->get_parameter("actuation_thread_cpus").as_integer_array()},
+			{"telemetry", node->telemetry_callback_group(),
+					(int) node->get_parameter("telemetry_thread_priority").as_int(),
+					node->get_parameter("telemetry_thread_cpus").as_integer_array()},
+			{"read", node->read_callback_group(),
+					(int) node->get_parameter("read_thread_priority").as_int(),
+					node->get_parameter("read_thread_cpus").as_integer_array()},
+	};
+	
+	vector<shared_ptr<rclcpp::executors::SingleThreadedExecutor>> executors;
+	vector<thread> threads;
+	for (auto &groupThread : groupThreads) {
+		auto executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+		executor->add_callback_group(groupThread.callbackGroup, node->get_node_base_interface());
+		executors.push_back(executor);
+		threads.emplace_back([node, executor, groupThread, lockMemory, stackPrefaultSize] {
+			// configure the thread before its first callback, then fault in its own stack
+			string error;
+			if (!configure_realtime_thread(groupThread.name, groupThread.priority, groupThread.cpus, error)) {
+				RCLCPP_WARN(node->get_logger(), "Thread '%s' keeps its default scheduling: %s",
+				            groupThread.name, error.c_str());
+			}
+			if (lockMemory) {
+				prefault_stack(stackPrefaultSize);
+			}
+			executor->spin();
+		});
+	}
+	
+	auto executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+	executor->add_node(node);
+	executor->spin();
+	// the context is shut down, stop the callback group threads too
+	for (auto &groupExecutor : executors) {
+		groupExecutor->cancel();
+	}
+	for (auto &groupThread : threads) {
+		groupThread.join();
+	}
+}
+
+int
+main(int argc, char *argv[]) {
+	rclcpp::init(argc, argv);
+	auto node = std::make_shared<TemperatureSystemsControllerNode>();
+	
+	// keep every page resident, page faults otherwise show up as latency spikes in the callbacks
+	auto lockMemory = node->get_parameter("lock_memory").as_bool();
+	auto stackPrefaultSize = (size_t) std::max<int64_t>(0, node->get_parameter("stack_prefault_size").as_int());
+	if (lockMemory) {
+		string error;
+		if (!lock_process_memory(error)) {
+			RCLCPP_WARN(node->get_logger(), "Memory is not locked: %s", error.c_str());
+		}
+		prefault_stack(stackPrefaultSize);
+	}
+	
+	// pick the executor configured on the node
+	auto executorType = node->get_parameter("executor").as_string();
+	if (executorType == "callback_group_threads") {
+		spin_callback_group_threads(node, lockMemory, stackPrefaultSize);
+		rclcpp::shutdown();
+		return 0;
+	}
+	shared_ptr<rclcpp::Executor> executor;
+	if (executorType == "multi_threaded") {
+		auto threads = (size_t) std::max<int64_t>(0, node->get_parameter("executor_threads").as_int());
+		executor = std::make_shared<rclcpp::executors::MultiThreadedExecutor>(rclcpp::ExecutorOptions(), threads);
+	} else if (executorType == "static_single_threaded") {
+		executor = std::make_shared<rclcpp::executors::StaticSingleThreadedExecutor>();
+	} else {
+		if (executorType != "single_threaded") {
+			RCLCPP_WARN(node->get_logger(), "Unknown executor '%s', falling back to 'single_threaded'",
+			            executorType.c_str());
+		}
+		executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+	}
+	
+	executor->add_node(node);
+	// every group may run on any thread, the threads of the multi threaded executor inherit the settings
+	node->configure_shared_executor_thread("executor");
+	executor->spin();
+	rclcpp::shutdown();
+	return 0;
+}
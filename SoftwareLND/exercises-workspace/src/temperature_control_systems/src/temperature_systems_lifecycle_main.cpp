@@ -0,0 +1,14 @@
+#include "temperature_control_systems/temperature_systems_lifecycle_node.hpp"
+
+int
+main(int argc, char *argv[]) {
+	rclcpp::init(argc, argv);
+	auto node = std::make_shared<TemperatureSystemsLifecycleNode>();
+	
+	// only the transitions spin here, the controller spins on its own threads once configured
+	rclcpp::executors::SingleThreadedExecutor executor;
+	executor.add_node(node->get_node_base_interface());
+	executor.spin();
+	rclcpp::shutdown();
+	return 0;
+}
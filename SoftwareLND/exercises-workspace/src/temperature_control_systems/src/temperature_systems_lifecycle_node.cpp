@@ -0,0 +1,110 @@
+#include "temperature_control_systems/temperature_systems_lifecycle_node.hpp"
+
+#include <exception>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+TemperatureSystemsLifecycleNode::TemperatureSystemsLifecycleNode(const rclcpp::NodeOptions &options)
+	: LifecycleNode("temperature_control_systems", options) {
+}
+
+TemperatureSystemsLifecycleNode::~TemperatureSystemsLifecycleNode() {
+	destroy_controller();
+}
+
+TemperatureSystemsLifecycleNode::CallbackReturn
+TemperatureSystemsLifecycleNode::on_configure(const rclcpp_lifecycle::State &) {
+	// the controller takes the parameters given to this node, command line and parameter files included
+	vector<rclcpp::Parameter> parameters;
+	for (auto &parameterOverride : this->get_node_parameters_interface()->get_parameter_overrides()) {
+		parameters.emplace_back(parameterOverride.first, parameterOverride.second);
+	}
+	// the global arguments would rename the controller after this node, its parameters are passed above
+	auto controllerOptions = rclcpp::NodeOptions()
+			.context(this->get_node_base_interface()->get_context())
+			.use_global_arguments(false)
+			.parameter_overrides(parameters);
+	// a parameter of the wrong type throws from the controller, the configuration can be retried once fixed
+	try {
+		controller = std::make_shared<TemperatureSystemsControllerNode>(
+				string(this->get_name()) + "_controller", this->get_namespace(), controllerOptions);
+		// nothing runs before the activation, the entities are already discovered by then
+		controller->set_active(false);
+		
+		// the callback groups of that executor are not added with the node, they need the standalone controller
+		auto executorType = controller->get_parameter("executor").as_string();
+		if (executorType == "callback_group_threads") {
+			RCLCPP_ERROR(this->get_logger(), "Executor '%s' is only supported by the standalone controller",
+			             executorType.c_str());
+			controller.reset();
+			return CallbackReturn::FAILURE;
+		}
+		// the callback groups run in parallel, as with the multi threaded executor of the standalone controller
+		auto threads = (size_t) std::max<int64_t>(0, controller->get_parameter("executor_threads").as_int());
+		controllerExecutor = std::make_shared<rclcpp::executors::MultiThreadedExecutor>(rclcpp::ExecutorOptions(),
+		                                                                                threads);
+		controllerExecutor->add_node(controller);
+	} catch (const std::exception &exception) {
+		RCLCPP_ERROR(this->get_logger(), "Couldn't configure the controller: %s", exception.what());
+		controllerExecutor.reset();
+		controller.reset();
+		return CallbackReturn::FAILURE;
+	}
+	promise<void> spinDone;
+	controllerSpinDone = spinDone.get_future();
+	controllerThread = thread([controller = controller, executor = controllerExecutor,
+	                           spinDone = std::move(spinDone)]() mutable {
+		// the threads of the executor inherit the real time settings of the callback groups
+		controller->configure_shared_executor_thread("controller");
+		executor->spin();
+		spinDone.set_value();
+	});
+	RCLCPP_INFO(this->get_logger(), "Controller configured");
+	return CallbackReturn::SUCCESS;
+}
+
+TemperatureSystemsLifecycleNode::CallbackReturn
+TemperatureSystemsLifecycleNode::on_activate(const rclcpp_lifecycle::State &) {
+	controller->set_active(true);
+	return CallbackReturn::SUCCESS;
+}
+
+TemperatureSystemsLifecycleNode::CallbackReturn
+TemperatureSystemsLifecycleNode::on_deactivate(const rclcpp_lifecycle::State &) {
+	controller->set_active(false);
+	return CallbackReturn::SUCCESS;
+}
+
+TemperatureSystemsLifecycleNode::CallbackReturn
+TemperatureSystemsLifecycleNode::on_cleanup(const rclcpp_lifecycle::State &) {
+	destroy_controller();
+	RCLCPP_INFO(this->get_logger(), "Controller cleaned up");
+	return CallbackReturn::SUCCESS;
+}
+
+TemperatureSystemsLifecycleNode::CallbackReturn
+TemperatureSystemsLifecycleNode::on_shutdown(const rclcpp_lifecycle::State &) {
+	destroy_controller();
+	return CallbackReturn::SUCCESS;
+}
+
+void
+TemperatureSystemsLifecycleNode::destroy_controller() {
+	if (!controller) {
+		return;
+	}
+	// a cancel arriving before the thread started spinning is lost, repeat it until the spin returns
+	do {
+		controllerExecutor->cancel();
+	} while (controllerSpinDone.wait_for(10ms) != future_status::ready);
+	controllerThread.join();
+	controllerExecutor.reset();
+	// the goals still running end with the controller
+	controller.reset();
+}
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+RCLCPP_COMPONENTS_REGISTER_NODE(TemperatureSystemsLifecycleNode)
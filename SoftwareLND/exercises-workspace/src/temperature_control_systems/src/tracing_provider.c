@@ -0,0 +1,5 @@
+// probes of the tracepoint provider, linked into the controller library
+#define TRACEPOINT_CREATE_PROBES
+#define TRACEPOINT_DEFINE
+
+#include "temperature_control_systems/tracing_provider.h"
@@ -0,0 +1,213 @@
+#ifndef TEMPERATURE_CONTROL_SYSTEMS_CLIENT__PIPELINED_CLIENT_HPP_
+#define TEMPERATURE_CONTROL_SYSTEMS_CLIENT__PIPELINED_CLIENT_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+// how a call ended, only responded calls carry a response
+enum class CallStatus {
+	RESPONDED,
+	TIMED_OUT,
+	OVERLOADED
+};
+
+// persistent service client keeping many calls in flight at once, each bounded by a timeout
+// calls made while the service is gone are held and sent once it is back, until their timeout
+// callbacks run on the executor spinning the node, calls may be made from any thread
+template<class ServiceT>
+class PipelinedClient {
+public:
+	using Request = typename ServiceT::Request;
+	using Response = typename ServiceT::Response;
+	// runs exactly once per call, the response is empty unless the call responded
+	using ResponseCallback = std::function<void(CallStatus, const std::shared_ptr<Response> &)>;
+	using CallResult = std::pair<CallStatus, std::shared_ptr<Response>>;
+
+private:
+	struct Call {
+		std::shared_ptr<Request> request;
+		ResponseCallback callback;
+		std::chrono::steady_clock::time_point deadline;
+		// id of the request in the rclcpp client, negative while held
+		int64_t requestId = -1;
+	};
+	
+	// everything the callbacks touch, they hold it weakly and do nothing once the client is destroyed
+	struct State {
+		// persistent client, it matches the service again whenever the server comes back
+		typename rclcpp::Client<ServiceT>::SharedPtr client;
+		// guards the calls, the executor and the callers touch them
+		std::mutex mutex;
+		// calls in flight or held, by call id
+		std::map<uint64_t, Call> calls;
+		// calls waiting for the service, oldest first
+		std::deque<uint64_t> heldCalls;
+		// id of the next call
+		uint64_t nextCallId = 0;
+		// longest time a call may take, waiting for the service included
+		std::chrono::nanoseconds timeout;
+		// calls in flight or held at once, the ones past it fail right away
+		size_t maxOutstandingCalls;
+	};
+	
+	// state shared with the callbacks, a callback already dispatched keeps it alive until it returns
+	std::shared_ptr<State> state;
+	// expires the calls past their deadline and sends the held ones once the service is ready
+	rclcpp::TimerBase::SharedPtr pollTimer;
+
+public:
+	PipelinedClient(const rclcpp::Node::SharedPtr &node, const std::string &serviceName,
+	                std::chrono::nanoseconds timeout, size_t maxOutstandingCalls,
+	                std::chrono::nanoseconds pollPeriod, const rclcpp::CallbackGroup::SharedPtr &callbackGroup)
+		: state(std::make_shared<State>()) {
+		state->client = node->template create_client<ServiceT>(serviceName, rmw_qos_profile_services_default,
+		                                                       callbackGroup);
+		state->timeout = timeout;
+		state->maxOutstandingCalls = maxOutstandingCalls;
+		// the timer keeps running, a timer restarted from another thread would not wake a waiting executor
+		pollTimer = node->create_wall_timer(
+				pollPeriod,
+				[weakState = std::weak_ptr<State>(state)] {
+					if (auto state = weakState.lock()) {
+						poll(state);
+					}
+				},
+				callbackGroup);
+	}
+	
+	~PipelinedClient() {
+		// no response or timeout may reach the client once it is gone, the ones already dispatched find no state
+		pollTimer->cancel();
+		state->client->prune_pending_requests();
+	}
+	
+	PipelinedClient(const PipelinedClient &) = delete;
+	
+	PipelinedClient &
+	operator=(const PipelinedClient &) = delete;
+	
+	// sends the request, or holds it until the service is ready
+	void
+	async_call(std::shared_ptr<Request> request, ResponseCallback callback) {
+		std::unique_lock<std::mutex> lock(state->mutex);
+		if (state->calls.size() >= state->maxOutstandingCalls) {
+			lock.unlock();
+			callback(CallStatus::OVERLOADED, nullptr);
+			return;
+		}
+		auto callId = state->nextCallId++;
+		auto &call = state->calls[callId];
+		call.request = std::move(request);
+		call.callback = std::move(callback);
+		call.deadline = std::chrono::steady_clock::now() + state->timeout;
+		if (state->heldCalls.empty() && state->client->service_is_ready()) {
+			send(state, callId, call);
+		} else {
+			state->heldCalls.push_back(callId);
+		}
+	}
+	
+	// same as above, the future must not be waited on by the thread spinning the node
+	std::shared_future<CallResult>
+	async_call(std::shared_ptr<Request> request) {
+		auto promise = std::make_shared<std::promise<CallResult>>();
+		auto future = promise->get_future().share();
+		async_call(std::move(request), [promise](CallStatus status, const std::shared_ptr<Response> &response) {
+			promise->set_value(CallResult(status, response));
+		});
+		return future;
+	}
+	
+	// number of calls in flight or held
+	size_t
+	outstanding_calls() {
+		std::lock_guard<std::mutex> lock(state->mutex);
+		return state->calls.size();
+	}
+	
+	// whether the service is matched right now
+	bool
+	service_is_ready() const {
+		return state->client->service_is_ready();
+	}
+
+private:
+	// called with the mutex held
+	static void
+	send(const std::shared_ptr<State> &state, uint64_t callId, Call &call) {
+		call.requestId = state->client->async_send_request(
+				call.request,
+				[weakState = std::weak_ptr<State>(state), callId](
+						typename rclcpp::Client<ServiceT>::SharedFuture future) {
+					if (auto state = weakState.lock()) {
+						complete(state, callId, future.get());
+					}
+				}).request_id;
+	}
+	
+	static void
+	complete(const std::shared_ptr<State> &state, uint64_t callId, const std::shared_ptr<Response> &response) {
+		ResponseCallback callback;
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			auto call = state->calls.find(callId);
+			// the call timed out already
+			if (call == state->calls.end()) {
+				return;
+			}
+			callback = std::move(call->second.callback);
+			state->calls.erase(call);
+		}
+		callback(CallStatus::RESPONDED, response);
+	}
+	
+	static void
+	poll(const std::shared_ptr<State> &state) {
+		std::vector<ResponseCallback> expiredCallbacks;
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			auto now = std::chrono::steady_clock::now();
+			// calls past their deadline fail, the client drops their late responses
+			for (auto call = state->calls.begin(); call != state->calls.end();) {
+				if (call->second.deadline > now) {
+					++call;
+					continue;
+				}
+				if (call->second.requestId >= 0) {
+					state->client->remove_pending_request(call->second.requestId);
+				}
+				expiredCallbacks.push_back(std::move(call->second.callback));
+				call = state->calls.erase(call);
+			}
+			// the service is back, send the held calls in order
+			if (state->client->service_is_ready()) {
+				for (auto callId : state->heldCalls) {
+					auto call = state->calls.find(callId);
+					if (call != state->calls.end()) {
+						send(state, callId, call->second);
+					}
+				}
+				state->heldCalls.clear();
+			} else if (state->calls.empty()) {
+				state->heldCalls.clear();
+			}
+		}
+		// callbacks may call again, they run without the mutex
+		for (auto &callback : expiredCallbacks) {
+			callback(CallStatus::TIMED_OUT, nullptr);
+		}
+	}
+};
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS_CLIENT__PIPELINED_CLIENT_HPP_
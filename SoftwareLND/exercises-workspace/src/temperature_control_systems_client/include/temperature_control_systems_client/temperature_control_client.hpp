@@ -0,0 +1,95 @@
+#ifndef TEMPERATURE_CONTROL_SYSTEMS_CLIENT__TEMPERATURE_CONTROL_CLIENT_HPP_
+#define TEMPERATURE_CONTROL_SYSTEMS_CLIENT__TEMPERATURE_CONTROL_CLIENT_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "temperature_control_systems_client/pipelined_client.hpp"
+
+#include "temperature_control_systems_interfaces/srv/get_current_temperature.hpp"
+#include "temperature_control_systems_interfaces/srv/increment_decrement_temperature_compact.hpp"
+
+// how a request to the controller ended
+enum class RequestStatus {
+	SUCCEEDED,
+	// the controller answered with a failure, an unknown zone or a refused actuation
+	REFUSED,
+	// no answer within the timeout, the controller may be gone
+	TIMED_OUT,
+	// too many requests outstanding, the request was never sent
+	OVERLOADED
+};
+
+// answer of the controller to a request
+struct TemperatureReply {
+	RequestStatus status = RequestStatus::TIMED_OUT;
+	// temperature of the zone reported by the controller
+	short temperature = 0;
+	// STATUS constant of the compact increment/decrement response, actuations only
+	uint8_t actuationStatus = 0;
+};
+
+struct TemperatureControlClientOptions {
+	// prefix of the services of the controller
+	std::string servicePrefix = "temperature_control_systems";
+	// longest time a request may take, waiting for the controller to come back included
+	std::chrono::milliseconds timeout{1000};
+	// requests outstanding at once per service
+	size_t maxOutstandingRequests = 64;
+	// period checking the timeouts and whether the controller is back
+	std::chrono::milliseconds pollPeriod{50};
+};
+
+// asynchronous client of the temperature controller, shared by every caller of a node
+// requests are pipelined on persistent clients, replies arrive on the executor spinning the node
+class TemperatureControlClient {
+public:
+	using GetCurrentTemperature = temperature_control_systems_interfaces::srv::GetCurrentTemperature;
+	using IncrementDecrementTemperature =
+			temperature_control_systems_interfaces::srv::IncrementDecrementTemperatureCompact;
+	using ReplyCallback = std::function<void(const TemperatureReply &)>;
+
+private:
+	// callback group of the clients, their replies never wait behind the other callbacks of the node
+	rclcpp::CallbackGroup::SharedPtr callbackGroup;
+	// client of the current temperature service
+	std::unique_ptr<PipelinedClient<GetCurrentTemperature>> readClient;
+	// client of the compact increment/decrement service
+	std::unique_ptr<PipelinedClient<IncrementDecrementTemperature>> actuationClient;
+
+public:
+	explicit TemperatureControlClient(const rclcpp::Node::SharedPtr &node,
+	                                  const TemperatureControlClientOptions &options = TemperatureControlClientOptions());
+	
+	// reads the current temperature of the zone
+	void
+	get_current_temperature(uint8_t zone, ReplyCallback callback);
+	
+	// same as above, the future must not be waited on by the thread spinning the node
+	std::shared_future<TemperatureReply>
+	get_current_temperature(uint8_t zone);
+	
+	// moves the temperature of the zone by the delta, a delta that is not positive is refused
+	void
+	increment_decrement_temperature(uint8_t zone, bool increment, short delta, ReplyCallback callback);
+	
+	// same as above, the future must not be waited on by the thread spinning the node
+	std::shared_future<TemperatureReply>
+	increment_decrement_temperature(uint8_t zone, bool increment, short delta);
+	
+	// whether every service of the controller is matched right now
+	bool
+	is_connected() const;
+	
+	// number of requests sent or waiting for the controller
+	size_t
+	outstanding_requests();
+};
+
+#endif  // TEMPERATURE_CONTROL_SYSTEMS_CLIENT__TEMPERATURE_CONTROL_CLIENT_HPP_
@@ -0,0 +1,94 @@
+#include "temperature_control_systems_client/temperature_control_client.hpp"
+
+using namespace std;
+
+namespace {
+// turns a reply callback into a future
+pair<TemperatureControlClient::ReplyCallback, shared_future<TemperatureReply>>
+reply_promise() {
+	auto promise = std::make_shared<std::promise<TemperatureReply>>();
+	auto future = promise->get_future().share();
+	return {[promise](const TemperatureReply &reply) { promise->set_value(reply); }, future};
+}
+
+// status of a call that never got a response
+RequestStatus
+unanswered_status(CallStatus status) {
+	return status == CallStatus::OVERLOADED ? RequestStatus::OVERLOADED : RequestStatus::TIMED_OUT;
+}
+}
+
+TemperatureControlClient::TemperatureControlClient(const rclcpp::Node::SharedPtr &node,
+                                                   const TemperatureControlClientOptions &options) {
+	callbackGroup = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+	readClient = std::make_unique<PipelinedClient<GetCurrentTemperature>>(
+			node, options.servicePrefix + "__get_current_temperature", options.timeout,
+			options.maxOutstandingRequests, options.pollPeriod, callbackGroup);
+	actuationClient = std::make_unique<PipelinedClient<IncrementDecrementTemperature>>(
+			node, options.servicePrefix + "__increment_decrement_temperature_compact", options.timeout,
+			options.maxOutstandingRequests, options.pollPeriod, callbackGroup);
+}
+
+void
+TemperatureControlClient::get_current_temperature(uint8_t zone, ReplyCallback callback) {
+	auto request = std::make_shared<GetCurrentTemperature::Request>();
+	request->zone = zone;
+	readClient->async_call(
+			request,
+			[callback](CallStatus status, const shared_ptr<GetCurrentTemperature::Response> &response) {
+				TemperatureReply reply;
+				if (status != CallStatus::RESPONDED) {
+					reply.status = unanswered_status(status);
+				} else {
+					reply.status = response->success ? RequestStatus::SUCCEEDED : RequestStatus::REFUSED;
+					reply.temperature = response->temperature;
+				}
+				callback(reply);
+			});
+}
+
+shared_future<TemperatureReply>
+TemperatureControlClient::get_current_temperature(uint8_t zone) {
+	auto reply = reply_promise();
+	get_current_temperature(zone, reply.first);
+	return reply.second;
+}
+
+void
+TemperatureControlClient::increment_decrement_temperature(uint8_t zone, bool increment, short delta,
+                                                          ReplyCallback callback) {
+	auto request = std::make_shared<IncrementDecrementTemperature::Request>();
+	request->zone = zone;
+	request->increment = increment;
+	request->delta = delta;
+	actuationClient->async_call(
+			request,
+			[callback](CallStatus status, const shared_ptr<IncrementDecrementTemperature::Response> &response) {
+				TemperatureReply reply;
+				if (status != CallStatus::RESPONDED) {
+					reply.status = unanswered_status(status);
+				} else {
+					reply.status = response->success ? RequestStatus::SUCCEEDED : RequestStatus::REFUSED;
+					reply.temperature = response->temperature;
+					reply.actuationStatus = response->status;
+				}
+				callback(reply);
+			});
+}
+
+shared_future<TemperatureReply>
+TemperatureControlClient::increment_decrement_temperature(uint8_t zone, bool increment, short delta) {
+	auto reply = reply_promise();
+	increment_decrement_temperature(zone, increment, delta, reply.first);
+	return reply.second;
+}
+
+bool
+TemperatureControlClient::is_connected() const {
+	return readClient->service_is_ready() && actuationClient->service_is_ready();
+}
+
+size_t
+TemperatureControlClient::outstanding_requests() {
+	return readClient->outstanding_calls() + actuationClient->outstanding_calls();
+}